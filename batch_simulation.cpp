@@ -0,0 +1,234 @@
+#include "batch_simulation.h"
+#include <cmath>
+
+void InitBatch(BatchWorlds &batch, int count, World const &templateWorld, uint64_t seed)
+{
+    batch.Count = count;
+    batch.Template = templateWorld;
+
+    batch.BallX.assign(count, 0.0f);
+    batch.BallY.assign(count, 0.0f);
+    batch.DirectionX.assign(count, 0.0f);
+    batch.DirectionY.assign(count, 0.0f);
+    batch.BallState.assign(count, Ball::NORMAL);
+    batch.RollTimer.assign(count, 0.0f);
+    batch.RollDirection.assign(count, 0.0f);
+    batch.SparkTimer.assign(count, 0.0f);
+    batch.KeeperY.assign(count, 0.0f);
+    batch.Score.assign(count, 0);
+    batch.Goals.assign(count, 0);
+    batch.SubtractScore.assign(count, 0);
+    batch.ShowMinus50.assign(count, 0);
+    batch.Minus50Timer.assign(count, 0.0f);
+    batch.GameOver.assign(count, 0);
+    batch.Random.assign(count, Rng());
+    batch.Input.assign(count, 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        SeedRng(batch.Random[i], seed + (uint64_t)i);
+        ResetBatchWorld(batch, i);
+    }
+}
+
+void ResetBatchWorld(BatchWorlds &batch, int index)
+{
+    World fresh = batch.Template;
+    ResetWorld(fresh);
+
+    batch.BallX[index] = fresh.ball.Position.x;
+    batch.BallY[index] = fresh.ball.Position.y;
+    batch.DirectionX[index] = fresh.ball.Direction.x;
+    batch.DirectionY[index] = fresh.ball.Direction.y;
+    batch.BallState[index] = fresh.ball.State;
+    batch.RollTimer[index] = fresh.ball.RollTimer;
+    batch.RollDirection[index] = fresh.ball.rollDirection;
+    batch.SparkTimer[index] = fresh.ball.sparkTimer;
+    batch.KeeperY[index] = fresh.keeper.Position.y;
+    batch.Score[index] = 0;
+    batch.Goals[index] = 0;
+    batch.GameOver[index] = 0;
+}
+
+static void BatchBallScored(BatchWorlds &batch, int i, Vector2 goalPosition, float radius)
+{
+    batch.Goals[i]++;
+    batch.BallX[i] = goalPosition.x - radius;
+    batch.BallY[i] = goalPosition.y;
+    batch.BallState[i] = Ball::ROLLING;
+    batch.RollTimer[i] = 4.0f;
+    batch.RollDirection[i] = (batch.DirectionY[i] >= 0) ? 1.0f : -1.0f;
+}
+
+static void BatchBallMissed(BatchWorlds &batch, int i)
+{
+    batch.ShowMinus50[i] = 1;
+    batch.Minus50Timer[i] = 1.0f;
+    batch.SubtractScore[i] = 1;
+    batch.BallX[i] = WORLD_WIDTH / 2;
+    batch.BallY[i] = WORLD_HEIGHT / 2;
+    batch.BallState[i] = Ball::SPARKING;
+    batch.SparkTimer[i] = 1.0f;
+}
+
+void StepBatch(BatchWorlds &batch, ThreadPool &pool, float deltaTime)
+{
+    RunParallel(pool, batch.Count, [&](int begin, int end) { StepBatchRange(batch, begin, end, deltaTime); });
+}
+
+// Same rules as Step() in simulation.cpp, written against the arrays
+void StepBatchRange(BatchWorlds &batch, int begin, int end, float deltaTime)
+{
+    Ball const &ball = batch.Template.ball;
+    Goalkeeper const &keeper = batch.Template.keeper;
+    Goal const &goal = batch.Template.goal;
+
+    // Geometry shared by every world
+    float radius = ball.Radius;
+    float keeperLeft = keeper.Position.x - keeper.Width / 2;
+    Rectangle goalRect = {goal.Position.x - goal.Width, goal.Position.y - goal.Height / 2, goal.Width, goal.Height};
+    float goalTop = goal.Position.y - goal.Height / 2 + ball.Radius;
+    float goalBottom = goal.Position.y + goal.Height / 2 - ball.Radius;
+    float distance = ball.Speed * deltaTime;
+    float rollDistance = ball.Speed * 0.2f * BALL_Y_SCALE * deltaTime;
+    float keeperStep = keeper.Speed * deltaTime;
+
+    for (int i = begin; i < end; i++)
+    {
+        unsigned char input = batch.Input[i];
+
+        if (batch.Score[i] < 0)
+        {
+            batch.GameOver[i] = 1;
+        }
+
+        // UpdateGame
+        if (!batch.GameOver[i])
+        {
+            if (batch.SubtractScore[i])
+            {
+                batch.Score[i] -= 50;
+                batch.SubtractScore[i] = 0;
+            }
+            if (batch.ShowMinus50[i])
+            {
+                batch.Minus50Timer[i] -= deltaTime;
+                if (batch.Minus50Timer[i] <= 0.0f)
+                {
+                    batch.ShowMinus50[i] = 0;
+                }
+            }
+
+            float keeperY = batch.KeeperY[i];
+            if ((input & BATCH_INPUT_UP) && keeperY - keeper.Height / 2 > 0)
+            {
+                batch.KeeperY[i] -= keeperStep;
+            }
+            if ((input & BATCH_INPUT_DOWN) && keeperY + keeper.Height / 2 < WORLD_HEIGHT)
+            {
+                batch.KeeperY[i] += keeperStep;
+            }
+
+            // UpdateBall
+            if (batch.BallState[i] == Ball::NORMAL)
+            {
+                BallArena arena = {
+                    radius, {keeperLeft, batch.KeeperY[i] - keeper.Height / 2, keeper.Width, keeper.Height}, goalRect,
+                    batch.KeeperY[i] - keeperY, nullptr};
+                Vector2 position = {batch.BallX[i], batch.BallY[i]};
+                Vector2 direction = {batch.DirectionX[i], batch.DirectionY[i]};
+                bool saved = false;
+                int outcome = SweepBall(arena, position, direction, distance, saved);
+                batch.BallX[i] = position.x;
+                batch.BallY[i] = position.y;
+                batch.DirectionX[i] = direction.x;
+                batch.DirectionY[i] = direction.y;
+                batch.Score[i] += saved ? 100 : 0;
+                if (outcome == SWEEP_GOAL)
+                {
+                    BatchBallScored(batch, i, goal.Position, ball.Radius);
+                }
+                else if (outcome == SWEEP_MISS)
+                {
+                    BatchBallMissed(batch, i);
+                }
+            }
+            else if (batch.BallState[i] == Ball::ROLLING)
+            {
+                batch.RollTimer[i] -= deltaTime;
+                float newY = batch.BallY[i] + batch.RollDirection[i] * rollDistance;
+                if (newY < goalTop)
+                {
+                    newY = goalTop;
+                    batch.RollDirection[i] = 1.0f;
+                }
+                else if (newY > goalBottom)
+                {
+                    newY = goalBottom;
+                    batch.RollDirection[i] = -1.0f;
+                }
+                batch.BallY[i] = newY;
+                batch.BallX[i] = goal.Position.x - ball.Radius;
+
+                if (batch.RollTimer[i] <= 0.0f)
+                {
+                    batch.BallX[i] = WORLD_WIDTH / 2;
+                    batch.BallY[i] = WORLD_HEIGHT / 2;
+                    batch.BallState[i] = Ball::SPARKING;
+                    batch.SparkTimer[i] = 1.0f;
+                }
+            }
+            else if (batch.BallState[i] == Ball::SPARKING)
+            {
+                batch.SparkTimer[i] -= deltaTime;
+                if (batch.SparkTimer[i] <= 0.0f)
+                {
+                    batch.BallState[i] = Ball::NORMAL;
+                    Vector2 direction = {-1.0f, (float)RandomRange(batch.Random[i], -100, 100) / 100.0f};
+                    direction = BallHeading(direction);
+                    batch.DirectionX[i] = direction.x;
+                    batch.DirectionY[i] = direction.y;
+                }
+            }
+        }
+
+        if (batch.GameOver[i] && (input & BATCH_INPUT_RESTART))
+        {
+            ResetBatchWorld(batch, i);
+        }
+
+        // BallWallCollision
+        if (batch.BallY[i] + radius >= WORLD_HEIGHT || batch.BallY[i] - radius <= 0)
+        {
+            batch.DirectionY[i] = -batch.DirectionY[i];
+            batch.BallY[i] = batch.BallY[i] + radius >= WORLD_HEIGHT ? WORLD_HEIGHT - radius : radius;
+        }
+        if (batch.BallX[i] - radius <= 0)
+        {
+            batch.DirectionX[i] = -batch.DirectionX[i];
+            batch.BallX[i] = radius;
+        }
+        if (batch.BallX[i] + radius >= WORLD_WIDTH && batch.BallState[i] == Ball::NORMAL)
+        {
+            BatchBallMissed(batch, i);
+        }
+
+        // BallGoalkeeperCollision
+        Rectangle keeperRect = {keeperLeft, batch.KeeperY[i] - keeper.Height / 2, keeper.Width, keeper.Height};
+        Vector2 ballPos = {batch.BallX[i], batch.BallY[i]};
+        if (batch.BallState[i] == Ball::NORMAL && batch.DirectionX[i] > 0.0f && ballPos.x < keeperLeft &&
+            SimCheckCollisionCircleRec(ballPos, radius, keeperRect))
+        {
+            batch.DirectionX[i] = -batch.DirectionX[i];
+            batch.BallX[i] = keeperLeft - radius;
+            batch.Score[i] += 100;
+        }
+
+        // BallGoalCollision
+        ballPos = {batch.BallX[i], batch.BallY[i]};
+        if (batch.BallState[i] == Ball::NORMAL && SimCheckCollisionCircleRec(ballPos, radius, goalRect))
+        {
+            BatchBallScored(batch, i, goal.Position, radius);
+        }
+    }
+}
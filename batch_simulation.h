@@ -0,0 +1,52 @@
+#ifndef BATCH_SIMULATION_H
+#define BATCH_SIMULATION_H
+
+#include "simulation.h"
+#include "thread_pool.h"
+#include <vector>
+
+// Input bits for one world in a batch
+enum
+{
+    BATCH_INPUT_UP = 1,
+    BATCH_INPUT_DOWN = 2,
+    BATCH_INPUT_RESTART = 4
+};
+
+// Many independent matches stored as structure-of-arrays.
+// Ball, keeper and goal geometry and speeds are shared and come from a template World,
+// everything that changes during a match has one array entry per world.
+// Effects, pause and bricks are not simulated.
+struct BatchWorlds
+{
+    int Count;
+    World Template;
+
+    std::vector<float> BallX;
+    std::vector<float> BallY;
+    std::vector<float> DirectionX;
+    std::vector<float> DirectionY;
+    std::vector<unsigned char> BallState;
+    std::vector<float> RollTimer;
+    std::vector<float> RollDirection;
+    std::vector<float> SparkTimer;
+
+    std::vector<float> KeeperY;
+
+    std::vector<int> Score;
+    std::vector<int> Goals;
+    std::vector<unsigned char> SubtractScore;
+    std::vector<unsigned char> ShowMinus50;
+    std::vector<float> Minus50Timer;
+    std::vector<unsigned char> GameOver;
+
+    std::vector<Rng> Random;          // Gameplay RNG, world i is seeded with seed + i
+    std::vector<unsigned char> Input; // BATCH_INPUT_* bits, read by the next StepBatch
+};
+
+void InitBatch(BatchWorlds &batch, int count, World const &templateWorld, uint64_t seed);
+void ResetBatchWorld(BatchWorlds &batch, int index);
+void StepBatch(BatchWorlds &batch, ThreadPool &pool, float deltaTime);
+void StepBatchRange(BatchWorlds &batch, int begin, int end, float deltaTime);
+
+#endif
@@ -0,0 +1,376 @@
+// Micro-benchmarks for the per-tick simulation cost.
+// Usage: footballArkanoid-bench [--filter TEXT] [--min-time SECONDS]
+// Each case repeats one call until it has run for at least --min-time and reports the time per call.
+// For Step, ops/s is the number of simulated frames per second.
+#include "keeper_ai.h"
+#include "multi_ball.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "soft_render.h"
+#include "state_hash.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+float const BENCH_DELTA = 1.0f / 120.0f;
+int const BENCH_PARTICLES = 4096;
+
+static ParticleStore benchParticles;
+static World benchWorld;
+static volatile float benchSink; // Keeps results alive so the calls can't be optimized away
+
+typedef void (*BenchSetup)(World &world);
+typedef void (*BenchBody)(World &world, long long iterations);
+
+struct BenchCase
+{
+    char const *Name;
+    BenchSetup Setup;
+    BenchBody Body;
+};
+
+// Setups
+
+// Keeper as tall as the pitch: every shot is saved, so the ball stays NORMAL forever
+static void SetupNormal(World &world)
+{
+    world.keeper.Height = WORLD_HEIGHT;
+    world.keeper.Position.y = WORLD_HEIGHT / 2;
+}
+
+static void SetupRolling(World &world)
+{
+    world.ball.State = Ball::ROLLING;
+    world.ball.RollTimer = 1e9f;
+    world.ball.rollDirection = 1.0f;
+    world.ball.Position.x = world.goal.Position.x - world.ball.Radius;
+}
+
+static void SetupSparking(World &world)
+{
+    world.ball.State = Ball::SPARKING;
+    world.ball.sparkTimer = 1e9f;
+}
+
+static void SetupParticles(World &world)
+{
+    world.particles = &benchParticles;
+}
+
+// Long-lived particles so the store stays full while it is being updated
+static void SetupFullParticles(World &world)
+{
+    world.particles = &benchParticles;
+    for (int i = 0; i < BENCH_PARTICLES; i++)
+    {
+        float spread = i * 0.01f;
+        Vector2 velocity = {spread - (int)spread, 1.0f - spread / 50};
+        EmitParticle(benchParticles, {WORLD_WIDTH / 2, WORLD_HEIGHT / 2}, velocity, MAROON, 10.0f, 1e9f, 1.5f);
+    }
+}
+
+// Every cell of the largest grid holds a brick
+static void SetupFullBricks(World &world)
+{
+    BrickField &bricks = world.bricks;
+    bricks.Area = {100, 100, 1024, 448};
+    bricks.Columns = BRICK_MAX_COLUMNS;
+    bricks.Rows = BRICK_MAX_ROWS;
+    bricks.CellWidth = bricks.Area.width / bricks.Columns;
+    bricks.CellHeight = bricks.Area.height / bricks.Rows;
+    memset(bricks.Level.Rows, 0xFF, sizeof(bricks.Level.Rows));
+    bricks.Level.Remaining = BRICK_MAX_COLUMNS * BRICK_MAX_ROWS;
+    RestoreBrickLevel(bricks);
+}
+
+// Bodies
+
+static void BenchUpdateBall(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        UpdateBall(world, world.ball, BENCH_DELTA);
+    }
+    benchSink = world.ball.Position.x + world.ball.Position.y;
+}
+
+static void BenchWallCollision(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        BallWallCollision(world, world.ball);
+    }
+    benchSink = world.ball.Direction.x;
+}
+
+static void BenchGoalkeeperCollision(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        BallGoalkeeperCollision(world, world.ball);
+    }
+    benchSink = world.ball.Direction.x;
+}
+
+static void BenchGoalCollision(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        BallGoalCollision(world, world.ball);
+    }
+    benchSink = (float)world.goals;
+}
+
+static void BenchGoalEffect(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        ClearParticleStore(benchParticles);
+        CreateGoalEffect(world, world.goal.Position);
+    }
+    benchSink = benchParticles.chunks[0]->x[0];
+}
+
+static void BenchSparkEffect(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        ClearParticleStore(benchParticles);
+        CreateSparkEffect(world, world.ball.Position);
+    }
+    benchSink = benchParticles.chunks[0]->x[0];
+}
+
+static void BenchUpdateParticles(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        UpdateParticles(world, BENCH_DELTA);
+    }
+    benchSink = benchParticles.chunks[0]->x[0];
+}
+
+// A whole tick as the game runs it, with the keeper following the ball
+static void BenchStep(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        SimInput input = {};
+        input.Up = world.ball.Position.y < world.keeper.Position.y - world.keeper.Height / 4;
+        input.Down = world.ball.Position.y > world.keeper.Position.y + world.keeper.Height / 4;
+        input.Restart = world.GameOver;
+        Step(world, input, BENCH_DELTA);
+    }
+    benchSink = (float)world.score;
+}
+
+static MultiBall benchMultiBall;
+
+static void SetupMultiBall(World &world)
+{
+    InitMultiBall(benchMultiBall, world, 1000, 1);
+}
+
+static void BenchStepMultiBall(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        StepMultiBall(world, benchMultiBall, BENCH_DELTA);
+    }
+    benchSink = (float)benchMultiBall.Contacts;
+}
+
+static KeeperAi benchKeeperAi;
+
+// Ball heading away, so every prediction folds the left wall bounce as well
+static void SetupKeeperAi(World &world)
+{
+    InitKeeperAi(benchKeeperAi, KEEPER_HARD, 1);
+    world.ball.Direction = BallHeading({-0.3f, 0.9f});
+}
+
+static void BenchKeeperAi(World &world, long long iterations)
+{
+    int moves = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        moves += KeeperAiInput(benchKeeperAi, world, BENCH_DELTA).Up;
+    }
+    benchSink = (float)moves;
+}
+
+static GameSnapshot benchSnapshot;
+
+static void BenchSaveSnapshot(World &world, long long iterations)
+{
+    for (long long i = 0; i < iterations; i++)
+    {
+        world.score = (int)i;
+        SaveSnapshot(benchSnapshot, world);
+    }
+    benchSink = (float)benchSnapshot.score;
+}
+
+static void BenchRestoreSnapshot(World &world, long long iterations)
+{
+    SaveSnapshot(benchSnapshot, world);
+    for (long long i = 0; i < iterations; i++)
+    {
+        benchSnapshot.score = (int)i;
+        RestoreSnapshot(world, benchSnapshot);
+    }
+    benchSink = (float)world.score;
+}
+
+// What recording a replay adds to every tick
+static void BenchHashWorldState(World &world, long long iterations)
+{
+    StateHash hash;
+    uint32_t combined = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        world.score = (int)i;
+        HashWorldState(world, hash);
+        combined ^= CombineStateHash(hash);
+    }
+    benchSink = (float)combined;
+}
+
+// One tick of the ball's move, starting along the top of the field and heading into it at varying angles
+static Vector2 BrickMoveStart(World const &world, long long i, Vector2 &delta)
+{
+    Rectangle const &area = world.bricks.Area;
+    float step = world.ball.Speed * BENCH_DELTA;
+    float along = (float)(i % 1000) / 1000.0f;
+    delta = {(along - 0.5f) * step, step};
+    return {area.x + along * area.width, area.y - world.ball.Radius - step / 2};
+}
+
+static void BenchSweepBricks(World &world, long long iterations)
+{
+    int hits = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        Vector2 delta;
+        Vector2 start = BrickMoveStart(world, i, delta);
+        int column, row;
+        hits += SweepBricks(world.bricks, start, delta, world.ball.Radius, column, row).Hit;
+    }
+    benchSink = (float)hits;
+}
+
+// What the grid saves: the same moves tested against every brick
+static void BenchSweepEveryBrick(World &world, long long iterations)
+{
+    BrickField const &bricks = world.bricks;
+    int hits = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        Vector2 delta;
+        Vector2 start = BrickMoveStart(world, i, delta);
+        SweepHit best = {false, 1.0f, {0.0f, 0.0f}};
+        for (int row = 0; row < bricks.Rows; row++)
+        {
+            for (int column = 0; column < bricks.Columns; column++)
+            {
+                if (HasBrick(bricks, column, row))
+                {
+                    SweepHit hit = SweepCircleRec(start, delta, world.ball.Radius, BrickRect(bricks, column, row));
+                    best = hit.Hit && hit.Time < best.Time ? hit : best;
+                }
+            }
+        }
+        hits += best.Hit;
+    }
+    benchSink = (float)hits;
+}
+
+static Canvas benchCanvas;
+
+// One window-sized software frame, with the full particle store on top
+static void BenchRenderWorld(World &world, long long iterations)
+{
+    InitCanvas(benchCanvas, (int)WORLD_WIDTH, (int)WORLD_HEIGHT);
+    for (long long i = 0; i < iterations; i++)
+    {
+        RenderWorld(benchCanvas, world, nullptr, 0, i * 1.5f);
+    }
+    benchSink = benchCanvas.Pixels[benchCanvas.Pixels.size() / 2].g;
+}
+
+static BenchCase const benchCases[] = {
+    {"UpdateBall/NORMAL", SetupNormal, BenchUpdateBall},
+    {"UpdateBall/ROLLING", SetupRolling, BenchUpdateBall},
+    {"UpdateBall/SPARKING", SetupSparking, BenchUpdateBall},
+    {"BallWallCollision", nullptr, BenchWallCollision},
+    {"BallGoalkeeperCollision", nullptr, BenchGoalkeeperCollision},
+    {"BallGoalCollision", nullptr, BenchGoalCollision},
+    {"CreateGoalEffect", SetupParticles, BenchGoalEffect},
+    {"CreateSparkEffect", SetupParticles, BenchSparkEffect},
+    {"UpdateParticles/4096", SetupFullParticles, BenchUpdateParticles},
+    {"Step", SetupParticles, BenchStep},
+    {"StepMultiBall/1000", SetupMultiBall, BenchStepMultiBall},
+    {"KeeperAiInput", SetupKeeperAi, BenchKeeperAi},
+    {"SaveSnapshot", nullptr, BenchSaveSnapshot},
+    {"RestoreSnapshot", nullptr, BenchRestoreSnapshot},
+    {"HashWorldState", nullptr, BenchHashWorldState},
+    {"SweepBricks/8192", SetupFullBricks, BenchSweepBricks},
+    {"SweepEveryBrick/8192", SetupFullBricks, BenchSweepEveryBrick},
+    {"RenderWorld/1250x650", SetupFullParticles, BenchRenderWorld},
+};
+
+static double RunBenchCase(BenchCase const &benchCase, long long iterations)
+{
+    InitWorld(benchWorld, 1);
+    ClearParticleStore(benchParticles);
+    if (benchCase.Setup)
+    {
+        benchCase.Setup(benchWorld);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    benchCase.Body(benchWorld, iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    char const *filter = nullptr;
+    double minTime = 0.5;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--filter") == 0)
+        {
+            filter = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0)
+        {
+            minTime = atof(argv[i + 1]);
+        }
+    }
+
+    printf("%-26s %12s %12s %14s\n", "benchmark", "iterations", "ns/op", "ops/s");
+    for (BenchCase const &benchCase : benchCases)
+    {
+        if (filter && !strstr(benchCase.Name, filter))
+        {
+            continue;
+        }
+
+        // Grow the iteration count until one run is long enough to trust the clock
+        long long iterations = 1;
+        double seconds = RunBenchCase(benchCase, iterations);
+        while (seconds < minTime && iterations < (1LL << 40))
+        {
+            double scale = seconds > 0.0 ? 1.4 * minTime / seconds : 100.0;
+            long long next = (long long)(iterations * (scale < 100.0 ? scale : 100.0));
+            iterations = next > iterations ? next : iterations * 2;
+            seconds = RunBenchCase(benchCase, iterations);
+        }
+
+        double nanoseconds = seconds * 1e9 / iterations;
+        printf("%-26s %12lld %12.2f %14.0f\n", benchCase.Name, iterations, nanoseconds, 1e9 / nanoseconds);
+    }
+    return 0;
+}
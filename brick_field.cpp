@@ -0,0 +1,225 @@
+#include "brick_field.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+void ClearBrickField(BrickField &field)
+{
+    memset(&field, 0, sizeof(field));
+}
+
+void CopyBrickCells(BrickCells &to, BrickCells const &from, int rows)
+{
+    memcpy(to.Rows, from.Rows, rows * sizeof(from.Rows[0]));
+    to.Remaining = from.Remaining;
+}
+
+void RestoreBrickLevel(BrickField &field)
+{
+    CopyBrickCells(field.Live, field.Level, field.Rows);
+}
+
+bool LoadBrickLevel(BrickField &field, char const *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+
+    BrickField loaded;
+    ClearBrickField(loaded);
+    bool hasArea = false;
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        char *text = line + strspn(line, " \t");
+        text[strcspn(text, "#\r\n")] = '\0';
+        if (text[0] == '\0')
+        {
+            continue;
+        }
+
+        Rectangle &area = loaded.Area;
+        char cells[BRICK_MAX_COLUMNS + 2];
+        if (sscanf(text, "area %f %f %f %f", &area.x, &area.y, &area.width, &area.height) == 4)
+        {
+            hasArea = area.width > 0.0f && area.height > 0.0f;
+            ok = hasArea;
+        }
+        else if (sscanf(text, "row %129s", cells) == 1 && loaded.Rows < BRICK_MAX_ROWS &&
+                 strlen(cells) <= (size_t)BRICK_MAX_COLUMNS && strspn(cells, "X.") == strlen(cells))
+        {
+            int row = loaded.Rows++;
+            int columns = (int)strlen(cells);
+            loaded.Columns = columns > loaded.Columns ? columns : loaded.Columns;
+            for (int column = 0; column < columns; column++)
+            {
+                if (cells[column] == 'X')
+                {
+                    loaded.Level.Rows[row][column / 64] |= 1ull << (column % 64);
+                    loaded.Level.Remaining++;
+                }
+            }
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "%s:%d: can't parse \"%s\"\n", path, lineNumber, text);
+        }
+    }
+    fclose(file);
+
+    if (ok && (!hasArea || loaded.Level.Remaining == 0))
+    {
+        fprintf(stderr, "%s: needs an area and at least one brick\n", path);
+        ok = false;
+    }
+    if (ok)
+    {
+        loaded.CellWidth = loaded.Area.width / loaded.Columns;
+        loaded.CellHeight = loaded.Area.height / loaded.Rows;
+        RestoreBrickLevel(loaded);
+        field = loaded;
+    }
+    return ok;
+}
+
+bool HasBrick(BrickField const &field, int column, int row)
+{
+    return (field.Live.Rows[row][column / 64] >> (column % 64)) & 1;
+}
+
+void RemoveBrick(BrickField &field, int column, int row)
+{
+    if (HasBrick(field, column, row))
+    {
+        field.Live.Rows[row][column / 64] &= ~(1ull << (column % 64));
+        field.Live.Remaining--;
+    }
+}
+
+Rectangle BrickRect(BrickField const &field, int column, int row)
+{
+    return {field.Area.x + column * field.CellWidth, field.Area.y + row * field.CellHeight, field.CellWidth,
+            field.CellHeight};
+}
+
+// Bricks in the cells within reach of the circle's center cell
+static void SweepNeighbours(BrickField const &field, Vector2 start, Vector2 delta, float radius, int centerColumn,
+                            int centerRow, int reachX, int reachY, SweepHit &best, int &column, int &row)
+{
+    int firstRow = centerRow - reachY > 0 ? centerRow - reachY : 0;
+    int lastRow = centerRow + reachY < field.Rows - 1 ? centerRow + reachY : field.Rows - 1;
+    int firstColumn = centerColumn - reachX > 0 ? centerColumn - reachX : 0;
+    int lastColumn = centerColumn + reachX < field.Columns - 1 ? centerColumn + reachX : field.Columns - 1;
+    for (int r = firstRow; r <= lastRow; r++)
+    {
+        for (int c = firstColumn; c <= lastColumn; c++)
+        {
+            if (!HasBrick(field, c, r))
+            {
+                continue;
+            }
+            SweepHit hit = SweepCircleRec(start, delta, radius, BrickRect(field, c, r));
+            bool approaching = hit.Normal.x * delta.x + hit.Normal.y * delta.y < 0.0f;
+            if (hit.Hit && approaching && (!best.Hit || hit.Time < best.Time))
+            {
+                best = hit;
+                column = c;
+                row = r;
+            }
+        }
+    }
+}
+
+SweepHit SweepBricks(BrickField const &field, Vector2 start, Vector2 delta, float radius, int &column, int &row)
+{
+    SweepHit best = {false, 1.0f, {0.0f, 0.0f}};
+    if (field.Live.Remaining == 0)
+    {
+        return best;
+    }
+
+    // Clip the move to the grid grown by the radius, most moves don't come near it
+    Rectangle const &area = field.Area;
+    float starts[2] = {start.x, start.y};
+    float deltas[2] = {delta.x, delta.y};
+    float mins[2] = {area.x - radius, area.y - radius};
+    float maxs[2] = {area.x + area.width + radius, area.y + area.height + radius};
+    float enter = 0.0f;
+    float exit = 1.0f;
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (deltas[axis] == 0.0f)
+        {
+            if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+            {
+                return best;
+            }
+            continue;
+        }
+        float entry = (mins[axis] - starts[axis]) / deltas[axis];
+        float leave = (maxs[axis] - starts[axis]) / deltas[axis];
+        enter = fmaxf(enter, fminf(entry, leave));
+        exit = fminf(exit, fmaxf(entry, leave));
+        if (enter > exit)
+        {
+            return best;
+        }
+    }
+
+    // Any brick the circle touches lies within this many cells of the cell holding its center
+    int reachX = (int)ceilf(radius / field.CellWidth);
+    int reachY = (int)ceilf(radius / field.CellHeight);
+
+    // Walk the center's cells in the order the move enters them (Amanatides & Woo)
+    Vector2 point = {start.x + delta.x * enter, start.y + delta.y * enter};
+    int cellX = (int)floorf((point.x - area.x) / field.CellWidth);
+    int cellY = (int)floorf((point.y - area.y) / field.CellHeight);
+    int stepX = delta.x > 0.0f ? 1 : delta.x < 0.0f ? -1 : 0;
+    int stepY = delta.y > 0.0f ? 1 : delta.y < 0.0f ? -1 : 0;
+    float nextX = INFINITY;
+    float nextY = INFINITY;
+    float stepTimeX = INFINITY;
+    float stepTimeY = INFINITY;
+    if (stepX != 0)
+    {
+        nextX = (area.x + (cellX + (stepX > 0)) * field.CellWidth - start.x) / delta.x;
+        stepTimeX = field.CellWidth / fabsf(delta.x);
+    }
+    if (stepY != 0)
+    {
+        nextY = (area.y + (cellY + (stepY > 0)) * field.CellHeight - start.y) / delta.y;
+        stepTimeY = field.CellHeight / fabsf(delta.y);
+    }
+
+    for (;;)
+    {
+        SweepNeighbours(field, start, delta, radius, cellX, cellY, reachX, reachY, best, column, row);
+        // A hit found so far beats anything around cells the center only reaches later
+        float next = fminf(nextX, nextY);
+        if (next > exit || (best.Hit && next > best.Time))
+        {
+            break;
+        }
+        if (nextX < nextY)
+        {
+            cellX += stepX;
+            nextX += stepTimeX;
+        }
+        else
+        {
+            cellY += stepY;
+            nextY += stepTimeY;
+        }
+    }
+    return best;
+}
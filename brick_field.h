@@ -0,0 +1,49 @@
+#ifndef BRICK_FIELD_H
+#define BRICK_FIELD_H
+
+#include "collision.h"
+#include "raylib.h"
+#include <stdint.h>
+
+// Destructible bricks on a uniform grid over part of the pitch. Occupancy is one bit per cell, so a
+// full 128 x 64 field is 1 KB of plain data that copies, snapshots and hashes with the rest of the world.
+// A moving ball only looks at the cells its path crosses (grid DDA), however many bricks there are.
+int const BRICK_MAX_COLUMNS = 128;
+int const BRICK_MAX_ROWS = 64;
+int const BRICK_ROW_WORDS = BRICK_MAX_COLUMNS / 64;
+
+struct BrickCells
+{
+    uint64_t Rows[BRICK_MAX_ROWS][BRICK_ROW_WORDS]; // Bit c % 64 of word c / 64 is column c
+    int Remaining;
+};
+
+struct BrickField
+{
+    Rectangle Area; // World units covered by the grid
+    float CellWidth;
+    float CellHeight;
+    int Columns; // 0 = no bricks
+    int Rows;
+    BrickCells Live;  // Bricks still standing
+    BrickCells Level; // As loaded, put back on restart and when the last brick breaks
+};
+
+// Level file, '#' starts a comment:
+//   area X Y WIDTH HEIGHT   part of the pitch the grid covers, in world units
+//   row CELLS               one per grid row from the top, X is a brick, . an empty cell
+// The grid is as wide as the longest row, its cells fill the area.
+bool LoadBrickLevel(BrickField &field, char const *path);
+void ClearBrickField(BrickField &field);
+void RestoreBrickLevel(BrickField &field); // Live = Level
+void CopyBrickCells(BrickCells &to, BrickCells const &from, int rows); // Only the first rows are used
+
+bool HasBrick(BrickField const &field, int column, int row);
+void RemoveBrick(BrickField &field, int column, int row);
+Rectangle BrickRect(BrickField const &field, int column, int row);
+
+// Earliest brick a circle moving from start to start + delta runs into, ignoring bricks it is
+// already moving away from. The cell of the hit is returned through column and row.
+SweepHit SweepBricks(BrickField const &field, Vector2 start, Vector2 delta, float radius, int &column, int &row);
+
+#endif
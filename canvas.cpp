@@ -0,0 +1,266 @@
+#include "canvas.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static unsigned char const PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+static int const STORED_BLOCK = 65535; // Largest deflate block without compression
+
+void InitCanvas(Canvas &canvas, int width, int height)
+{
+    canvas.Width = width;
+    canvas.Height = height;
+    canvas.Pixels.assign((size_t)width * height, BLACK);
+}
+
+bool WriteCanvasPpm(Canvas const &canvas, char const *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", canvas.Width, canvas.Height);
+    std::vector<unsigned char> row((size_t)canvas.Width * 3);
+    for (int y = 0; y < canvas.Height; y++)
+    {
+        Color const *pixels = &canvas.Pixels[(size_t)y * canvas.Width];
+        for (int x = 0; x < canvas.Width; x++)
+        {
+            row[x * 3] = pixels[x].r;
+            row[x * 3 + 1] = pixels[x].g;
+            row[x * 3 + 2] = pixels[x].b;
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+static uint32_t Crc32(uint32_t crc, unsigned char const *data, size_t size)
+{
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+            {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<unsigned char> &out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static uint32_t GetBigEndian(unsigned char const *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static void WriteChunk(FILE *file, char const type[4], std::vector<unsigned char> const &data)
+{
+    std::vector<unsigned char> chunk;
+    PutBigEndian(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutBigEndian(chunk, Crc32(0, &chunk[4], chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+bool WriteCanvasPng(Canvas const &canvas, char const *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fwrite(PNG_SIGNATURE, 1, sizeof(PNG_SIGNATURE), file);
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)canvas.Width);
+    PutBigEndian(header, (uint32_t)canvas.Height);
+    unsigned char format[5] = {8, 6, 0, 0, 0}; // 8-bit RGBA, deflate, no filter, no interlace
+    header.insert(header.end(), format, format + 5);
+    WriteChunk(file, "IHDR", header);
+
+    // Scanlines each lead with filter type 0
+    size_t rowBytes = (size_t)canvas.Width * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * canvas.Height);
+    for (int y = 0; y < canvas.Height; y++)
+    {
+        raw.push_back(0);
+        unsigned char const *row = (unsigned char const *)&canvas.Pixels[(size_t)y * canvas.Width];
+        raw.insert(raw.end(), row, row + rowBytes);
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<unsigned char> data = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < raw.size(); offset += STORED_BLOCK)
+    {
+        size_t size = raw.size() - offset < (size_t)STORED_BLOCK ? raw.size() - offset : STORED_BLOCK;
+        data.push_back(offset + size == raw.size() ? 1 : 0);
+        data.push_back((unsigned char)size);
+        data.push_back((unsigned char)(size >> 8));
+        data.push_back((unsigned char)~size);
+        data.push_back((unsigned char)(~size >> 8));
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + size);
+        for (size_t i = offset; i < offset + size; i++)
+        {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    PutBigEndian(data, b << 16 | a);
+    WriteChunk(file, "IDAT", data);
+    WriteChunk(file, "IEND", std::vector<unsigned char>());
+    return fclose(file) == 0;
+}
+
+static bool ReadFile(char const *path, std::vector<unsigned char> &bytes)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + got);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool ReadPpm(Canvas &canvas, std::vector<unsigned char> const &bytes, char const *path)
+{
+    int width, height, maxValue, headerLength;
+    std::string header((char const *)bytes.data(), bytes.size() < 64 ? bytes.size() : 64);
+    if (sscanf(header.c_str(), "P6 %d %d %d%n", &width, &height, &maxValue, &headerLength) != 3 || maxValue != 255 ||
+        width <= 0 || height <= 0)
+    {
+        fprintf(stderr, "%s: only 8-bit binary PPM (P6) is supported\n", path);
+        return false;
+    }
+    headerLength++; // The single whitespace after maxval
+    if (bytes.size() < headerLength + (size_t)width * height * 3)
+    {
+        fprintf(stderr, "%s: truncated\n", path);
+        return false;
+    }
+    InitCanvas(canvas, width, height);
+    unsigned char const *rgb = &bytes[headerLength];
+    for (size_t i = 0; i < canvas.Pixels.size(); i++)
+    {
+        canvas.Pixels[i] = (Color){rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], 255};
+    }
+    return true;
+}
+
+static bool ReadPng(Canvas &canvas, std::vector<unsigned char> const &bytes, char const *path)
+{
+    int width = 0, height = 0;
+    std::vector<unsigned char> data;
+    for (size_t offset = sizeof(PNG_SIGNATURE); offset + 12 <= bytes.size();)
+    {
+        uint32_t size = GetBigEndian(&bytes[offset]);
+        if (offset + 12 + size > bytes.size())
+        {
+            break;
+        }
+        char const *type = (char const *)&bytes[offset + 4];
+        unsigned char const *body = &bytes[offset + 8];
+        if (memcmp(type, "IHDR", 4) == 0)
+        {
+            width = (int)GetBigEndian(body);
+            height = (int)GetBigEndian(body + 4);
+            if (body[8] != 8 || body[9] != 6 || body[12] != 0)
+            {
+                fprintf(stderr, "%s: only 8-bit RGBA non-interlaced PNG is supported\n", path);
+                return false;
+            }
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            data.insert(data.end(), body, body + size);
+        }
+        offset += 12 + size;
+    }
+
+    // Undo the stored deflate blocks, skipping the 2-byte zlib header
+    std::vector<unsigned char> raw;
+    bool last = false;
+    size_t at = 2;
+    while (!last && at + 5 <= data.size())
+    {
+        last = data[at] & 1;
+        if ((data[at] >> 1 & 3) != 0)
+        {
+            fprintf(stderr, "%s: compressed PNG, only images written by this game can be read\n", path);
+            return false;
+        }
+        size_t size = data[at + 1] | data[at + 2] << 8;
+        at += 5;
+        if (at + size > data.size())
+        {
+            break;
+        }
+        raw.insert(raw.end(), data.begin() + at, data.begin() + at + size);
+        at += size;
+    }
+
+    size_t rowBytes = (size_t)width * 4;
+    if (width <= 0 || height <= 0 || raw.size() < (rowBytes + 1) * height)
+    {
+        fprintf(stderr, "%s: truncated or not a PNG\n", path);
+        return false;
+    }
+    InitCanvas(canvas, width, height);
+    for (int y = 0; y < height; y++)
+    {
+        unsigned char const *row = &raw[y * (rowBytes + 1)];
+        if (row[0] != 0)
+        {
+            fprintf(stderr, "%s: filtered PNG, only images written by this game can be read\n", path);
+            return false;
+        }
+        memcpy(&canvas.Pixels[(size_t)y * width], row + 1, rowBytes);
+    }
+    return true;
+}
+
+bool ReadCanvas(Canvas &canvas, char const *path)
+{
+    std::vector<unsigned char> bytes;
+    if (!ReadFile(path, bytes))
+    {
+        fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+    if (bytes.size() >= sizeof(PNG_SIGNATURE) && memcmp(bytes.data(), PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0)
+    {
+        return ReadPng(canvas, bytes, path);
+    }
+    return ReadPpm(canvas, bytes, path);
+}
@@ -0,0 +1,23 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+// In-memory RGBA image and its file formats, no window or GPU needed
+#include "raylib.h"
+#include <vector>
+
+struct Canvas
+{
+    int Width;
+    int Height;
+    std::vector<Color> Pixels; // Row-major, top row first
+};
+
+void InitCanvas(Canvas &canvas, int width, int height);
+
+// Binary PPM (P6, alpha dropped) or PNG (RGBA, stored without compression, so no zlib needed)
+bool WriteCanvasPpm(Canvas const &canvas, char const *path);
+bool WriteCanvasPng(Canvas const &canvas, char const *path);
+// Reads PPM, or the PNGs written above. Prints what is wrong and returns false for anything else.
+bool ReadCanvas(Canvas &canvas, char const *path);
+
+#endif
@@ -0,0 +1,151 @@
+#include "collision.h"
+#include <cmath>
+
+static SweepHit NoHit(void)
+{
+    SweepHit hit = {false, 1.0f, {0.0f, 0.0f}};
+    return hit;
+}
+
+// Circle already overlapping: contact now, pushed out along the shortest way
+static SweepHit OverlapHit(Vector2 center, float radius, Rectangle rec)
+{
+    float closestX = fminf(fmaxf(center.x, rec.x), rec.x + rec.width);
+    float closestY = fminf(fmaxf(center.y, rec.y), rec.y + rec.height);
+    float dx = center.x - closestX;
+    float dy = center.y - closestY;
+    float distanceSq = dx * dx + dy * dy;
+    if (distanceSq > radius * radius)
+    {
+        return NoHit();
+    }
+
+    SweepHit hit = {true, 0.0f, {0.0f, 0.0f}};
+    if (distanceSq > 0.0f)
+    {
+        float distance = sqrtf(distanceSq);
+        hit.Normal = {dx / distance, dy / distance};
+        return hit;
+    }
+
+    // Center inside the rectangle, leave through the nearest side
+    float left = center.x - rec.x;
+    float right = rec.x + rec.width - center.x;
+    float top = center.y - rec.y;
+    float bottom = rec.y + rec.height - center.y;
+    float nearest = fminf(fminf(left, right), fminf(top, bottom));
+    if (nearest == left)
+    {
+        hit.Normal = {-1.0f, 0.0f};
+    }
+    else if (nearest == right)
+    {
+        hit.Normal = {1.0f, 0.0f};
+    }
+    else if (nearest == top)
+    {
+        hit.Normal = {0.0f, -1.0f};
+    }
+    else
+    {
+        hit.Normal = {0.0f, 1.0f};
+    }
+    return hit;
+}
+
+// Earliest t in [0, 1] where the moving point is at distance radius from corner
+static bool SweepPointCircle(Vector2 start, Vector2 delta, Vector2 corner, float radius, float &time)
+{
+    float mx = start.x - corner.x;
+    float my = start.y - corner.y;
+    float a = delta.x * delta.x + delta.y * delta.y;
+    float b = mx * delta.x + my * delta.y;
+    float c = mx * mx + my * my - radius * radius;
+    if (a == 0.0f || b > 0.0f)
+    {
+        return false;
+    }
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f)
+    {
+        return false;
+    }
+    time = (-b - sqrtf(discriminant)) / a;
+    return time >= 0.0f && time <= 1.0f;
+}
+
+SweepHit SweepCircleRec(Vector2 start, Vector2 delta, float radius, Rectangle rec)
+{
+    SweepHit overlap = OverlapHit(start, radius, rec);
+    if (overlap.Hit)
+    {
+        return overlap;
+    }
+
+    // Ray against the rectangle grown by the radius (slab test)
+    float minX = rec.x - radius;
+    float maxX = rec.x + rec.width + radius;
+    float minY = rec.y - radius;
+    float maxY = rec.y + rec.height + radius;
+
+    float enter = 0.0f;
+    float exit = 1.0f;
+    Vector2 normal = {0.0f, 0.0f};
+    float starts[2] = {start.x, start.y};
+    float deltas[2] = {delta.x, delta.y};
+    float mins[2] = {minX, minY};
+    float maxs[2] = {maxX, maxY};
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (deltas[axis] == 0.0f)
+        {
+            if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+            {
+                return NoHit();
+            }
+            continue;
+        }
+
+        float inverse = 1.0f / deltas[axis];
+        float entry = (mins[axis] - starts[axis]) * inverse;
+        float leave = (maxs[axis] - starts[axis]) * inverse;
+        float side = -1.0f;
+        if (entry > leave)
+        {
+            float swap = entry;
+            entry = leave;
+            leave = swap;
+            side = 1.0f;
+        }
+        if (entry > enter)
+        {
+            enter = entry;
+            normal = axis == 0 ? (Vector2){side, 0.0f} : (Vector2){0.0f, side};
+        }
+        exit = fminf(exit, leave);
+        if (enter > exit)
+        {
+            return NoHit();
+        }
+    }
+
+    // The grown box has square corners, the real shape is rounded there
+    Vector2 point = {start.x + delta.x * enter, start.y + delta.y * enter};
+    bool outsideX = point.x < rec.x || point.x > rec.x + rec.width;
+    bool outsideY = point.y < rec.y || point.y > rec.y + rec.height;
+    if (outsideX && outsideY)
+    {
+        Vector2 corner = {point.x < rec.x ? rec.x : rec.x + rec.width, point.y < rec.y ? rec.y : rec.y + rec.height};
+        float time;
+        if (!SweepPointCircle(start, delta, corner, radius, time))
+        {
+            return NoHit();
+        }
+        Vector2 contact = {start.x + delta.x * time, start.y + delta.y * time};
+        SweepHit hit = {true, time, {(contact.x - corner.x) / radius, (contact.y - corner.y) / radius}};
+        return hit;
+    }
+
+    SweepHit hit = {true, enter, normal};
+    return hit;
+}
@@ -0,0 +1,17 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "raylib.h"
+
+// Result of moving a circle along a segment against a rectangle
+struct SweepHit
+{
+    bool Hit;
+    float Time;     // Fraction of the move at first contact, 0 when already touching
+    Vector2 Normal; // Points from the rectangle towards the circle
+};
+
+// Continuous circle vs axis-aligned rectangle test for a circle moving from start to start + delta
+SweepHit SweepCircleRec(Vector2 start, Vector2 delta, float radius, Rectangle rec);
+
+#endif
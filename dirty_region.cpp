@@ -0,0 +1,63 @@
+#include "dirty_region.h"
+#include <cmath>
+
+void ClearDirtyRegion(DirtyRegion &region)
+{
+    region = {};
+}
+
+void MarkDirty(DirtyRegion &region, Rectangle rect)
+{
+    if (rect.width <= 0.0f || rect.height <= 0.0f)
+    {
+        return;
+    }
+    if (!region.Any)
+    {
+        region.Any = true;
+        region.Bounds = rect;
+        return;
+    }
+    float left = fminf(region.Bounds.x, rect.x);
+    float top = fminf(region.Bounds.y, rect.y);
+    float right = fmaxf(region.Bounds.x + region.Bounds.width, rect.x + rect.width);
+    float bottom = fmaxf(region.Bounds.y + region.Bounds.height, rect.y + rect.height);
+    region.Bounds = {left, top, right - left, bottom - top};
+}
+
+void MarkAllDirty(DirtyRegion &region, int width, int height)
+{
+    MarkDirty(region, {0, 0, (float)width, (float)height});
+}
+
+void MarkMoved(DirtyRegion &region, Rectangle before, Rectangle after)
+{
+    if (before.x != after.x || before.y != after.y || before.width != after.width || before.height != after.height)
+    {
+        MarkDirty(region, before);
+        MarkDirty(region, after);
+    }
+}
+
+bool DirtyScissor(DirtyRegion const &region, int width, int height, int pad, int &x, int &y, int &w, int &h)
+{
+    if (!region.Any)
+    {
+        return false;
+    }
+    int left = (int)floorf(region.Bounds.x) - pad;
+    int top = (int)floorf(region.Bounds.y) - pad;
+    int right = (int)ceilf(region.Bounds.x + region.Bounds.width) + pad;
+    int bottom = (int)ceilf(region.Bounds.y + region.Bounds.height) + pad;
+    x = left > 0 ? left : 0;
+    y = top > 0 ? top : 0;
+    w = (right < width ? right : width) - x;
+    h = (bottom < height ? bottom : height) - y;
+    return w > 0 && h > 0;
+}
+
+Rectangle WorldToScreenRect(Rectangle rect, Camera2D view)
+{
+    return {view.offset.x + (rect.x - view.target.x) * view.zoom, view.offset.y + (rect.y - view.target.y) * view.zoom,
+            rect.width * view.zoom, rect.height * view.zoom};
+}
@@ -0,0 +1,24 @@
+#ifndef DIRTY_REGION_H
+#define DIRTY_REGION_H
+
+#include "raylib.h"
+
+// Screen area that changed since the last presented frame, kept as one bounding box.
+// The moving parts of a frame sit close together, and one box is one scissor rectangle.
+struct DirtyRegion
+{
+    bool Any;
+    Rectangle Bounds;
+};
+
+void ClearDirtyRegion(DirtyRegion &region);
+void MarkDirty(DirtyRegion &region, Rectangle rect);
+void MarkAllDirty(DirtyRegion &region, int width, int height);
+// Marks both rectangles when something was drawn at `before` and now is at `after`
+void MarkMoved(DirtyRegion &region, Rectangle before, Rectangle after);
+// Whole pixels covering the region grown by `pad`, clipped to the screen. false when nothing is left.
+bool DirtyScissor(DirtyRegion const &region, int width, int height, int pad, int &x, int &y, int &w, int &h);
+
+Rectangle WorldToScreenRect(Rectangle rect, Camera2D view); // For views without rotation
+
+#endif
@@ -0,0 +1,271 @@
+#include "effects.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+static EffectDesc BlankEffect(char const *name)
+{
+    EffectDesc effect = {};
+    snprintf(effect.Name, sizeof(effect.Name), "%s", name);
+    effect.Size[0] = effect.Size[1] = 1.0f;
+    effect.Life[0] = effect.Life[1] = 1.0f;
+    effect.FadeTime = 1.0f;
+    effect.FadeCurve = FADE_LINEAR;
+    effect.Tint = WHITE;
+    effect.Blend = BLEND_ALPHA;
+    return effect;
+}
+
+void DefaultEffects(EffectLibrary &library)
+{
+    library.Count = 0;
+
+    EffectDesc goal = BlankEffect("goal");
+    goal.Burst = 32;
+    goal.VelocityMode = VELOCITY_BOX;
+    goal.VelocityA[0] = goal.VelocityB[0] = -2.0f;
+    goal.VelocityA[1] = goal.VelocityB[1] = 2.0f;
+    goal.Size[0] = 5.0f;
+    goal.Size[1] = 20.0f;
+    goal.Life[0] = 0.5f;
+    goal.Life[1] = 2.0f;
+    goal.FadeTime = 1.5f;
+    goal.Tint = MAROON;
+    library.Effects[library.Count++] = goal;
+
+    EffectDesc spark = BlankEffect("spark");
+    spark.Burst = 15;
+    spark.VelocityMode = VELOCITY_POLAR;
+    spark.VelocityA[0] = 0.5f;
+    spark.VelocityA[1] = 1.5f;
+    spark.VelocityB[0] = 0.0f;
+    spark.VelocityB[1] = 360.0f;
+    spark.Size[0] = 4.0f;
+    spark.Size[1] = 10.0f;
+    spark.Life[0] = 0.1f;
+    spark.Life[1] = 0.6f;
+    spark.FadeTime = 0.5f;
+    spark.Tint = (Color){200, 220, 255, 255};
+    spark.Blend = BLEND_ADDITIVE;
+    library.Effects[library.Count++] = spark;
+}
+
+static long long FileModifiedTime(char const *path)
+{
+    struct stat info;
+    return stat(path, &info) == 0 ? (long long)info.st_mtime : 0;
+}
+
+static bool ParseFadeCurve(char const *name, int &curve)
+{
+    char const *names[FADE_CURVE_COUNT] = {"linear", "ease-in", "ease-out"};
+    for (int i = 0; i < FADE_CURVE_COUNT; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            curve = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// One "key values..." line of the current effect, false if it doesn't parse
+static bool ParseEffectLine(EffectDesc &effect, char const *line)
+{
+    char word[32];
+    int r, g, b, a;
+    if (sscanf(line, "burst %d", &effect.Burst) == 1)
+    {
+        return effect.Burst >= 0;
+    }
+    if (sscanf(line, "rate %f", &effect.Rate) == 1)
+    {
+        return effect.Rate >= 0.0f;
+    }
+    if (sscanf(line, "velocity box %f %f %f %f", &effect.VelocityA[0], &effect.VelocityA[1], &effect.VelocityB[0],
+               &effect.VelocityB[1]) == 4)
+    {
+        effect.VelocityMode = VELOCITY_BOX;
+        return true;
+    }
+    if (sscanf(line, "velocity polar %f %f %f %f", &effect.VelocityA[0], &effect.VelocityA[1], &effect.VelocityB[0],
+               &effect.VelocityB[1]) == 4)
+    {
+        effect.VelocityMode = VELOCITY_POLAR;
+        return true;
+    }
+    if (sscanf(line, "size %f %f", &effect.Size[0], &effect.Size[1]) == 2)
+    {
+        return true;
+    }
+    if (sscanf(line, "life %f %f", &effect.Life[0], &effect.Life[1]) == 2)
+    {
+        return effect.Life[0] > 0.0f && effect.Life[1] >= effect.Life[0];
+    }
+    if (sscanf(line, "fade %f %31s", &effect.FadeTime, word) == 2)
+    {
+        return effect.FadeTime > 0.0f && ParseFadeCurve(word, effect.FadeCurve);
+    }
+    if (sscanf(line, "color %d %d %d %d", &r, &g, &b, &a) == 4)
+    {
+        effect.Tint = (Color){(unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)a};
+        return true;
+    }
+    if (sscanf(line, "blend %31s", word) == 1)
+    {
+        effect.Blend = strcmp(word, "additive") == 0 ? BLEND_ADDITIVE : BLEND_ALPHA;
+        return strcmp(word, "additive") == 0 || strcmp(word, "alpha") == 0;
+    }
+    return false;
+}
+
+bool LoadEffects(EffectLibrary &library, char const *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        // Keep watching, the file is loaded as soon as it is created
+        fprintf(stderr, "%s: can't open\n", path);
+        snprintf(library.Path, sizeof(library.Path), "%s", path);
+        library.ModifiedTime = 0;
+        return false;
+    }
+
+    EffectLibrary loaded = {};
+    EffectDesc *current = nullptr;
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        char *text = line + strspn(line, " \t");
+        text[strcspn(text, "#\r\n")] = '\0';
+        if (text[0] == '\0')
+        {
+            continue;
+        }
+
+        char name[32];
+        if (sscanf(text, "effect %31s", name) == 1)
+        {
+            if (loaded.Count == MAX_EFFECTS || FindEffect(loaded, name))
+            {
+                fprintf(stderr, "%s:%d: too many effects or duplicate name %s\n", path, lineNumber, name);
+                ok = false;
+                break;
+            }
+            current = &loaded.Effects[loaded.Count++];
+            *current = BlankEffect(name);
+        }
+        else if (!current || !ParseEffectLine(*current, text))
+        {
+            fprintf(stderr, "%s:%d: can't parse \"%s\"\n", path, lineNumber, text);
+            ok = false;
+        }
+    }
+    fclose(file);
+
+    if (ok)
+    {
+        snprintf(loaded.Path, sizeof(loaded.Path), "%s", path);
+        loaded.ModifiedTime = FileModifiedTime(path);
+        loaded.Loads = library.Loads + 1;
+        library = loaded;
+    }
+    else
+    {
+        // Don't retry a broken file every frame, wait for the next save
+        snprintf(library.Path, sizeof(library.Path), "%s", path);
+        library.ModifiedTime = FileModifiedTime(path);
+    }
+    return ok;
+}
+
+bool ReloadEffectsIfChanged(EffectLibrary &library)
+{
+    if (library.Path[0] == '\0')
+    {
+        return false;
+    }
+    long long modified = FileModifiedTime(library.Path);
+    if (modified == 0 || modified == library.ModifiedTime)
+    {
+        return false;
+    }
+    char path[sizeof(library.Path)];
+    memcpy(path, library.Path, sizeof(path));
+    return LoadEffects(library, path);
+}
+
+EffectDesc const *FindEffect(EffectLibrary const &library, char const *name)
+{
+    for (int i = 0; i < library.Count; i++)
+    {
+        if (strcmp(library.Effects[i].Name, name) == 0)
+        {
+            return &library.Effects[i];
+        }
+    }
+    return nullptr;
+}
+
+int EmitEffect(ParticleStore &store, Rng &rng, EffectDesc const &effect, Vector2 position, int count)
+{
+    int first;
+    int granted = ReserveParticles(store, count, first);
+    float fadeA, fadeB;
+    SetFadeCurve(fadeA, fadeB, effect.FadeCurve);
+    float invFade = 1.0f / effect.FadeTime;
+
+    // Fill lane by lane, one slab at a time
+    int end = first + granted;
+    for (int index = first; index < end;)
+    {
+        ParticleChunk &chunk = *store.chunks[index / PARTICLE_CHUNK];
+        int begin = index % PARTICLE_CHUNK;
+        int stop = begin + (end - index) < PARTICLE_CHUNK ? begin + (end - index) : PARTICLE_CHUNK;
+
+        for (int i = begin; i < stop; i++)
+        {
+            chunk.x[i] = position.x;
+            chunk.y[i] = position.y;
+            chunk.invFade[i] = invFade;
+            chunk.fadeA[i] = fadeA;
+            chunk.fadeB[i] = fadeB;
+            chunk.alpha[i] = 1.0f;
+            chunk.color[i] = effect.Tint;
+            chunk.blend[i] = (unsigned char)effect.Blend;
+        }
+        for (int i = begin; i < stop; i++)
+        {
+            float a = RandomFloat(rng, effect.VelocityA[0], effect.VelocityA[1]);
+            float b = RandomFloat(rng, effect.VelocityB[0], effect.VelocityB[1]);
+            if (effect.VelocityMode == VELOCITY_POLAR)
+            {
+                chunk.vx[i] = cosf(b * DEG2RAD) * a;
+                chunk.vy[i] = sinf(b * DEG2RAD) * a;
+            }
+            else
+            {
+                chunk.vx[i] = a;
+                chunk.vy[i] = b;
+            }
+            chunk.size[i] = RandomFloat(rng, effect.Size[0], effect.Size[1]);
+            chunk.life[i] = RandomFloat(rng, effect.Life[0], effect.Life[1]);
+        }
+        index += stop - begin;
+    }
+    return granted;
+}
+
+int UpdateEmitter(ParticleStore &store, Rng &rng, EffectDesc const &effect, EffectEmitter &emitter,
+                  Vector2 position, float deltaTime)
+{
+    emitter.Carry += effect.Rate * deltaTime;
+    int count = (int)emitter.Carry;
+    emitter.Carry -= count;
+    return count > 0 ? EmitEffect(store, rng, effect, position, count) : 0;
+}
@@ -0,0 +1,58 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include "particles.h"
+#include "rng.h"
+
+int const MAX_EFFECTS = 16;
+
+enum
+{
+    VELOCITY_BOX,  // VelocityA is the x range, VelocityB the y range
+    VELOCITY_POLAR // VelocityA is the speed range, VelocityB the angle range in degrees
+};
+
+// How one effect spawns particles. Every range is uniform between its two values.
+struct EffectDesc
+{
+    char Name[32];
+    int Burst;  // Particles per trigger
+    float Rate; // Particles per second while an emitter runs the effect, 0 = bursts only
+    int VelocityMode;
+    float VelocityA[2];
+    float VelocityB[2];
+    float Size[2];
+    float Life[2];
+    float FadeTime; // Seconds from full to no alpha, a shorter life cuts the fade off
+    int FadeCurve;  // FADE_*
+    Color Tint;
+    int Blend;      // BLEND_ALPHA or BLEND_ADDITIVE
+};
+
+// Effect descriptors read from a text file, see resources/effects.txt for the format
+struct EffectLibrary
+{
+    EffectDesc Effects[MAX_EFFECTS];
+    int Count;
+    char Path[256];
+    long long ModifiedTime; // Of Path when it was last read, 0 if it never was
+    int Loads;              // Successful loads, including hot reloads
+};
+
+// Continuous emission of one effect
+struct EffectEmitter
+{
+    float Carry; // Part of a particle owed from earlier updates
+};
+
+void DefaultEffects(EffectLibrary &library); // Built-in goal and spark, used when no file is loaded
+bool LoadEffects(EffectLibrary &library, char const *path); // On any error the current effects stay
+bool ReloadEffectsIfChanged(EffectLibrary &library);        // true when the file changed and loaded fine
+EffectDesc const *FindEffect(EffectLibrary const &library, char const *name);
+
+// Spawn `count` particles of one effect in a single reservation, returns how many fit
+int EmitEffect(ParticleStore &store, Rng &rng, EffectDesc const &effect, Vector2 position, int count);
+int UpdateEmitter(ParticleStore &store, Rng &rng, EffectDesc const &effect, EffectEmitter &emitter,
+                  Vector2 position, float deltaTime);
+
+#endif
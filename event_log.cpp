@@ -0,0 +1,54 @@
+#include "event_log.h"
+#include <algorithm>
+
+static char const *const EVENT_NAMES[EVENT_TYPE_COUNT] = {
+    "save", "goal", "miss", "game over", "restart", "pause", "resume", "brick",
+};
+
+void InitEventRing(EventRing &ring, int capacity)
+{
+    uint32_t size = 1;
+    while (size < (uint32_t)std::max(capacity, 1))
+    {
+        size *= 2;
+    }
+    ring.Events.assign(size, GameEvent());
+    ring.Mask = size - 1;
+    ring.Tick = 0;
+    ring.Dropped = 0;
+    ring.Head.store(0, std::memory_order_relaxed);
+    ring.Tail.store(0, std::memory_order_relaxed);
+}
+
+bool PushEvent(EventRing &ring, GameEvent const &event)
+{
+    uint32_t head = ring.Head.load(std::memory_order_relaxed);
+    if (head - ring.Tail.load(std::memory_order_acquire) > ring.Mask)
+    {
+        ring.Dropped++;
+        return false;
+    }
+    ring.Events[head & ring.Mask] = event;
+    // The consumer sees the event before it sees the new head
+    ring.Head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+int PopEvents(EventRing &ring, GameEvent *out, int capacity)
+{
+    uint32_t tail = ring.Tail.load(std::memory_order_relaxed);
+    uint32_t available = ring.Head.load(std::memory_order_acquire) - tail;
+    int count = (int)std::min(available, (uint32_t)capacity);
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = ring.Events[(tail + i) & ring.Mask];
+    }
+    // Slots are only reused by the producer after this store
+    ring.Tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+char const *EventTypeName(int type)
+{
+    return type >= 0 && type < EVENT_TYPE_COUNT ? EVENT_NAMES[type] : "?";
+}
@@ -0,0 +1,55 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+// What the rules report as it happens, for play analytics
+enum
+{
+    EVENT_SAVE,      // Ball bounced off the keeper, +100
+    EVENT_GOAL,      // Ball in the goal
+    EVENT_MISS,      // Ball past the keeper's line outside the goal, -50
+    EVENT_GAME_OVER, // Score went below zero
+    EVENT_RESTART,
+    EVENT_PAUSE,
+    EVENT_RESUME,
+    EVENT_BRICK, // Ball broke a brick, +20
+    EVENT_TYPE_COUNT
+};
+
+// One event, also the on-disk record, so it is plain data with a fixed size
+struct GameEvent
+{
+    uint32_t Tick; // Tick it happened in, the first tick after the ring was created is 1
+    uint8_t Type;  // EVENT_*
+    uint8_t Reserved[3];
+    int32_t Score; // Score and goals right after the event
+    int32_t Goals;
+    float X; // Ball position
+    float Y;
+};
+static_assert(sizeof(GameEvent) == 24, "GameEvent is a file record");
+
+// Single-producer single-consumer queue: the simulation thread pushes, one other thread pops.
+// Neither side locks, waits or allocates after InitEventRing, a push into a full ring drops the event.
+struct EventRing
+{
+    std::vector<GameEvent> Events; // Power of two entries
+    uint32_t Mask;
+    uint32_t Tick;     // Producer side, ticks started so far
+    long long Dropped; // Producer side
+    char Padding1[64]; // Head and Tail on their own cache lines, so the two threads don't share one
+    std::atomic<uint32_t> Head; // Next slot to write, only the producer stores it
+    char Padding2[64];
+    std::atomic<uint32_t> Tail; // Next slot to read, only the consumer stores it
+    char Padding3[64];
+};
+
+void InitEventRing(EventRing &ring, int capacity); // Rounded up to a power of two
+bool PushEvent(EventRing &ring, GameEvent const &event);
+int PopEvents(EventRing &ring, GameEvent *out, int capacity); // Returns how many were copied to out
+char const *EventTypeName(int type);
+
+#endif
@@ -0,0 +1,222 @@
+// Event log reader: summarizes a telemetry file written with --telemetry.
+// Usage: footballArkanoid-events FILE [--list]
+// --list also prints every event, one per line.
+// The file is memory-mapped and scanned in one pass, the records are used in place.
+#include "event_log.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int const RECORD_SIZE = (int)sizeof(GameEvent);
+
+struct EventFile
+{
+    unsigned char const *Data;
+    long long Size;
+    std::vector<unsigned char> Copy; // When the file couldn't be mapped
+};
+
+static uint32_t GetU32(unsigned char const *in)
+{
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static bool ReadWholeFile(EventFile &file, char const *path)
+{
+    FILE *stream = fopen(path, "rb");
+    if (!stream)
+    {
+        return false;
+    }
+    unsigned char buffer[1 << 16];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+    {
+        file.Copy.insert(file.Copy.end(), buffer, buffer + got);
+    }
+    fclose(stream);
+    file.Data = file.Copy.data();
+    file.Size = (long long)file.Copy.size();
+    return true;
+}
+
+static bool OpenEventFile(EventFile &file, char const *path)
+{
+    file.Data = nullptr;
+    file.Size = 0;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+            file.Data = (unsigned char const *)data;
+            file.Size = info.st_size;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (file.Data)
+    {
+        return true;
+    }
+#endif
+    return ReadWholeFile(file, path);
+}
+
+static void CloseEventFile(EventFile &file)
+{
+#ifndef _WIN32
+    if (file.Copy.empty() && file.Data)
+    {
+        munmap((void *)file.Data, file.Size);
+    }
+#endif
+    file.Data = nullptr;
+}
+
+struct EventSummary
+{
+    long long Count[EVENT_TYPE_COUNT];
+    uint32_t FirstTick;
+    uint32_t LastTick;
+    int BestScore;          // Highest score reached
+    int MostGoals;          // Most goals conceded in one game
+    long long Games;        // Restarts + 1
+    long long LongestRally; // Most saves between two goals or misses
+};
+
+static void Summarize(GameEvent const *events, long long count, EventSummary &summary)
+{
+    summary = {};
+    summary.Games = count > 0 ? 1 : 0;
+    summary.FirstTick = count > 0 ? events[0].Tick : 0;
+    long long rally = 0;
+    for (long long i = 0; i < count; i++)
+    {
+        GameEvent const &event = events[i];
+        if (event.Type >= EVENT_TYPE_COUNT)
+        {
+            continue;
+        }
+        summary.Count[event.Type]++;
+        summary.LastTick = event.Tick;
+        summary.BestScore = event.Score > summary.BestScore ? event.Score : summary.BestScore;
+        summary.MostGoals = event.Goals > summary.MostGoals ? event.Goals : summary.MostGoals;
+        if (event.Type == EVENT_SAVE)
+        {
+            rally++;
+            summary.LongestRally = rally > summary.LongestRally ? rally : summary.LongestRally;
+        }
+        else if (event.Type == EVENT_GOAL || event.Type == EVENT_MISS || event.Type == EVENT_RESTART)
+        {
+            rally = 0;
+        }
+        if (event.Type == EVENT_RESTART)
+        {
+            summary.Games++;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    char const *path = nullptr;
+    bool list = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--list") == 0)
+        {
+            list = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (!path)
+    {
+        fprintf(stderr, "usage: footballArkanoid-events FILE [--list]\n");
+        return 1;
+    }
+
+    EventFile file;
+    if (!OpenEventFile(file, path))
+    {
+        fprintf(stderr, "could not read %s\n", path);
+        return 1;
+    }
+    unsigned char const *header = file.Data;
+    if (file.Size < RECORD_SIZE || memcmp(header, "FAEV", 4) != 0 || (header[4] | (header[5] << 8)) != 1 ||
+        header[6] != RECORD_SIZE)
+    {
+        fprintf(stderr, "%s is not an event log\n", path);
+        CloseEventFile(file);
+        return 1;
+    }
+    long long count = GetU32(header + 8) | ((long long)GetU32(header + 12) << 32);
+    uint32_t tickRateBits = GetU32(header + 16);
+    float tickRate;
+    memcpy(&tickRate, &tickRateBits, sizeof(tickRate));
+
+    // Records start on an 8-byte boundary of the mapping, the structs are read in place
+    GameEvent const *events = (GameEvent const *)(file.Data + RECORD_SIZE);
+    long long records = file.Size / RECORD_SIZE - 1;
+    bool complete = count > 0 || records == 0;
+    if (!complete)
+    {
+        // Never closed: the events end where the unwritten, zeroed records begin
+        while (count < records && events[count].Tick != 0)
+        {
+            count++;
+        }
+    }
+    count = count < records ? count : records;
+
+    auto start = std::chrono::steady_clock::now();
+    EventSummary summary;
+    Summarize(events, count, summary);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (list)
+    {
+        for (long long i = 0; i < count; i++)
+        {
+            GameEvent const &event = events[i];
+            printf("%10u %-9s score %6d goals %3d ball %7.1f %6.1f\n", event.Tick, EventTypeName(event.Type),
+                   event.Score, event.Goals, event.X, event.Y);
+        }
+    }
+
+    uint32_t ticks = summary.LastTick >= summary.FirstTick ? summary.LastTick - summary.FirstTick : 0;
+    double minutes = tickRate > 0.0f ? ticks / tickRate / 60.0 : 0.0;
+    printf("events: %lld%s, scanned in %.3f ms (%.0f M events/s)\n", count, complete ? "" : " (log not closed)",
+           seconds * 1000.0, seconds > 0.0 ? count / seconds / 1e6 : 0.0);
+    printf("ticks: %u to %u (%.1f min at %.0f Hz)\n", summary.FirstTick, summary.LastTick, minutes, tickRate);
+    printf("type         count  per minute\n");
+    for (int type = 0; type < EVENT_TYPE_COUNT; type++)
+    {
+        printf("%-9s %8lld %11.2f\n", EventTypeName(type), summary.Count[type],
+               minutes > 0.0 ? summary.Count[type] / minutes : 0.0);
+    }
+    long long shots = summary.Count[EVENT_SAVE] + summary.Count[EVENT_GOAL] + summary.Count[EVENT_MISS];
+    printf("games: %lld  best score: %d  most goals in a game: %d\n", summary.Games, summary.BestScore,
+           summary.MostGoals);
+    printf("save rate: %.1f%%  longest rally: %lld saves\n",
+           shots > 0 ? 100.0 * summary.Count[EVENT_SAVE] / shots : 0.0, summary.LongestRally);
+    CloseEventFile(file);
+    return 0;
+}
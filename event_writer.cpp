@@ -0,0 +1,179 @@
+#include "event_writer.h"
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static uint16_t const EVENT_LOG_VERSION = 1;
+static int const RECORD_SIZE = (int)sizeof(GameEvent);
+
+static void PutU32(unsigned char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void PutCount(unsigned char *out, long long count)
+{
+    PutU32(out, (uint32_t)count);
+    PutU32(out + 4, (uint32_t)((uint64_t)count >> 32));
+}
+
+static void MakeHeader(unsigned char header[RECORD_SIZE], float tickRate)
+{
+    uint32_t tickRateBits;
+    memcpy(&tickRateBits, &tickRate, sizeof(tickRateBits));
+    memset(header, 0, RECORD_SIZE);
+    memcpy(header, "FAEV", 4);
+    header[4] = EVENT_LOG_VERSION & 0xFF;
+    header[5] = EVENT_LOG_VERSION >> 8;
+    header[6] = RECORD_SIZE;
+    PutCount(header + 8, 0);
+    PutU32(header + 16, tickRateBits);
+}
+
+#ifndef _WIN32
+static bool MapWindow(EventWriter &writer, long long start)
+{
+    if (ftruncate(writer.File, start + EVENT_WINDOW_BYTES) != 0)
+    {
+        return false;
+    }
+    void *window = mmap(nullptr, EVENT_WINDOW_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, writer.File, start);
+    if (window == MAP_FAILED)
+    {
+        return false;
+    }
+    writer.Window = (unsigned char *)window;
+    writer.WindowStart = start;
+    return true;
+}
+
+// Pops straight into the mapping, returns the events written, -1 when the file can't grow
+static int DrainEvents(EventWriter &writer)
+{
+    long long offset = (writer.Written + 1) * RECORD_SIZE - writer.WindowStart;
+    if (offset == EVENT_WINDOW_BYTES)
+    {
+        munmap(writer.Window, EVENT_WINDOW_BYTES);
+        writer.Window = nullptr;
+        if (!MapWindow(writer, writer.WindowStart + EVENT_WINDOW_BYTES))
+        {
+            return -1;
+        }
+        offset = 0;
+    }
+    int space = (int)((EVENT_WINDOW_BYTES - offset) / RECORD_SIZE);
+    int count = PopEvents(writer.Ring, (GameEvent *)(writer.Window + offset), space);
+    writer.Written += count;
+    return count;
+}
+#else
+static int DrainEvents(EventWriter &writer)
+{
+    GameEvent batch[256];
+    int count = PopEvents(writer.Ring, batch, 256);
+    if (count > 0 && fwrite(batch, RECORD_SIZE, count, writer.Stream) != (size_t)count)
+    {
+        return -1;
+    }
+    writer.Written += count;
+    return count;
+}
+#endif
+
+static void WriterLoop(EventWriter *writer)
+{
+    for (;;)
+    {
+        // The flag is read before draining, so whatever was pushed before it went down still gets written
+        bool running = writer->Running.load(std::memory_order_acquire);
+        int count = DrainEvents(*writer);
+        if (count < 0 || (count == 0 && !running))
+        {
+            return;
+        }
+        if (count == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+bool OpenEventWriter(EventWriter &writer, char const *path, int capacity, float tickRate)
+{
+    InitEventRing(writer.Ring, capacity);
+    writer.File = -1;
+    writer.Stream = nullptr;
+    writer.Window = nullptr;
+    writer.WindowStart = 0;
+    writer.Written = 0;
+
+    unsigned char header[RECORD_SIZE];
+    MakeHeader(header, tickRate);
+#ifndef _WIN32
+    writer.File = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (writer.File < 0)
+    {
+        return false;
+    }
+    if (!MapWindow(writer, 0))
+    {
+        close(writer.File);
+        writer.File = -1;
+        return false;
+    }
+    memcpy(writer.Window, header, RECORD_SIZE);
+#else
+    writer.Stream = fopen(path, "wb");
+    if (!writer.Stream || fwrite(header, RECORD_SIZE, 1, writer.Stream) != 1)
+    {
+        if (writer.Stream)
+        {
+            fclose(writer.Stream);
+            writer.Stream = nullptr;
+        }
+        return false;
+    }
+#endif
+    writer.Running.store(true, std::memory_order_release);
+    writer.Thread = std::thread(WriterLoop, &writer);
+    return true;
+}
+
+void CloseEventWriter(EventWriter &writer)
+{
+    if (!writer.Thread.joinable())
+    {
+        return;
+    }
+    writer.Running.store(false, std::memory_order_release);
+    writer.Thread.join();
+
+    unsigned char count[8];
+    PutCount(count, writer.Written);
+#ifndef _WIN32
+    if (writer.Window)
+    {
+        munmap(writer.Window, EVENT_WINDOW_BYTES);
+        writer.Window = nullptr;
+    }
+    // Cut off the unused end of the last window
+    bool ok = ftruncate(writer.File, (writer.Written + 1) * RECORD_SIZE) == 0 &&
+              pwrite(writer.File, count, sizeof(count), 8) == (ssize_t)sizeof(count);
+    (void)ok; // Without the count the reader still finds the events
+    close(writer.File);
+    writer.File = -1;
+#else
+    fseek(writer.Stream, 8, SEEK_SET);
+    fwrite(count, sizeof(count), 1, writer.Stream);
+    fclose(writer.Stream);
+    writer.Stream = nullptr;
+#endif
+}
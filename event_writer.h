@@ -0,0 +1,39 @@
+#ifndef EVENT_WRITER_H
+#define EVENT_WRITER_H
+
+#include "event_log.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// Append-only event log file, filled by a background thread that drains an EventRing.
+// The game thread only ever pushes into the ring, it never touches the file.
+//
+// File layout, little endian, in GameEvent sized records:
+//   "FAEV"  u16 version  u16 record size  u64 event count  f32 tick rate  u32 reserved
+//   event count GameEvent records
+// The count is written on close. A file left behind by a crash has count 0, its events are the records up to
+// the first one with tick 0.
+//
+// On POSIX systems the file grows in mapped windows and records are copied straight from the ring into the
+// mapping, the kernel writes them back. Elsewhere they go through stdio.
+long long const EVENT_WINDOW_BYTES = 24 * 65536; // Whole records and whole pages
+
+struct EventWriter
+{
+    EventRing Ring;
+    std::thread Thread;
+    std::atomic<bool> Running;
+
+    int File;               // POSIX file descriptor, -1 when closed
+    FILE *Stream;           // stdio fallback
+    unsigned char *Window;  // Mapped part of the file
+    long long WindowStart;  // File offset of Window
+    long long Written;      // Events in the file
+};
+
+bool OpenEventWriter(EventWriter &writer, char const *path, int capacity, float tickRate);
+// Drains what's left in the ring, writes the count and closes the file
+void CloseEventWriter(EventWriter &writer);
+
+#endif
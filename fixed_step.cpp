@@ -0,0 +1,44 @@
+#include "fixed_step.h"
+
+FixedStep MakeFixedStep(float tickRate, int maxSteps)
+{
+    FixedStep clock = {};
+    clock.Enabled = true;
+    clock.TickRate = tickRate > 0.0f ? tickRate : 120.0f;
+    clock.MaxSteps = maxSteps > 0 ? maxSteps : 1;
+    return clock;
+}
+
+int AdvanceFixedStep(FixedStep &clock, float frameTime)
+{
+    clock.FrameTime = frameTime;
+    if (!clock.Enabled)
+    {
+        return 1;
+    }
+
+    double tick = 1.0 / clock.TickRate;
+    clock.Accumulator += frameTime;
+    int steps = (int)(clock.Accumulator / tick);
+    if (steps > clock.MaxSteps)
+    {
+        // Hitch: run the allowed amount and forget the rest instead of spiralling
+        steps = clock.MaxSteps;
+        clock.Accumulator = 0.0;
+    }
+    else
+    {
+        clock.Accumulator -= steps * tick;
+    }
+    return steps;
+}
+
+float FixedStepDelta(FixedStep const &clock)
+{
+    return clock.Enabled ? 1.0f / clock.TickRate : clock.FrameTime;
+}
+
+float FixedStepAlpha(FixedStep const &clock)
+{
+    return clock.Enabled ? (float)(clock.Accumulator * clock.TickRate) : 1.0f;
+}
@@ -0,0 +1,19 @@
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+// Accumulator that turns variable frame times into a whole number of fixed ticks.
+struct FixedStep
+{
+    bool Enabled;      // false = one variable step per frame (old behavior)
+    float TickRate;    // simulation ticks per second
+    int MaxSteps;      // catch-up limit per frame, extra time is dropped
+    double Accumulator;
+    float FrameTime;   // last frame time, used as the step in variable mode
+};
+
+FixedStep MakeFixedStep(float tickRate, int maxSteps);
+int AdvanceFixedStep(FixedStep &clock, float frameTime); // Number of ticks to run this frame
+float FixedStepDelta(FixedStep const &clock);            // Duration of one tick
+float FixedStepAlpha(FixedStep const &clock);            // Fraction of a tick left over, for interpolation
+
+#endif
@@ -0,0 +1,418 @@
+// Headless soak runner: drives the simulation without a window or GPU.
+// Usage: footballArkanoid-headless [--frames N] [--tick-rate HZ] [--seed N] [--record FILE]
+//                                   [--batch WORLDS] [--threads N] [--balls EXTRA] [--ai SKILL]
+//                                   [--telemetry FILE] [--level FILE]
+//        footballArkanoid-headless --replay FILE
+//        footballArkanoid-headless --render TICK,TICK,... [--render-dir DIR] [--render-format png|ppm]
+//                                  [--render-size WxH] [--tick-rate HZ] [--seed N] [--ai SKILL] [--level FILE]
+// --render draws the scripted game with the CPU rasterizer at each listed tick (0 = before the first step)
+// and writes DIR/tick_NNNNNN.png, for comparing against goldens with footballArkanoid-imgdiff.
+// --replay re-simulates FILE and names the first tick and state fields that differ from the recording.
+// --telemetry writes the game events of a single or multi-ball run, see footballArkanoid-events.
+// --level plays on the brick field of a level file such as resources/level.txt, by default there is none.
+// Batch worlds have no bricks, --level with --batch is an error.
+// --ai easy|normal|hard|perfect plays the keeper with the predictive AI instead of plain ball following.
+#include "batch_simulation.h"
+#include "event_writer.h"
+#include "keeper_ai.h"
+#include "multi_ball.h"
+#include "replay.h"
+#include "simulation.h"
+#include "soft_render.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Follow the ball with the keeper, good enough to keep a long game going, or let the AI keeper play
+SimInput ScriptedInput(World const &world, KeeperAi *ai, float deltaTime)
+{
+    SimInput input = {};
+    if (ai)
+    {
+        input = KeeperAiInput(*ai, world, deltaTime);
+    }
+    else
+    {
+        float target = world.ball.Position.y;
+        input.Up = target < world.keeper.Position.y - world.keeper.Height / 4;
+        input.Down = target > world.keeper.Position.y + world.keeper.Height / 4;
+    }
+    input.Restart = world.GameOver;
+    return input;
+}
+
+unsigned char ScriptedBatchInput(BatchWorlds const &batch, int index)
+{
+    float quarterKeeper = batch.Template.keeper.Height / 4;
+    unsigned char input = 0;
+    if (batch.BallY[index] < batch.KeeperY[index] - quarterKeeper)
+    {
+        input |= BATCH_INPUT_UP;
+    }
+    if (batch.BallY[index] > batch.KeeperY[index] + quarterKeeper)
+    {
+        input |= BATCH_INPUT_DOWN;
+    }
+    if (batch.GameOver[index])
+    {
+        input |= BATCH_INPUT_RESTART;
+    }
+    return input;
+}
+
+// Loaded once by main, every run starts with all of its bricks standing
+static BrickField level;
+
+int RunSingle(long frames, float tickRate, uint64_t seed, char const *recordPath, KeeperAi *ai, EventRing *events)
+{
+    float deltaTime = 1.0f / tickRate;
+    World world;
+    InitWorld(world, seed);
+    world.bricks = level;
+    world.events = events;
+    Replay replay;
+    BeginReplay(replay, seed, tickRate);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long frame = 0; frame < frames; frame++)
+    {
+        SimInput input = ScriptedInput(world, ai, deltaTime);
+        if (recordPath)
+        {
+            RecordReplayTick(replay, world, input);
+        }
+        Step(world, input, deltaTime);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (recordPath)
+    {
+        FinishReplay(replay, world);
+        if (!SaveReplay(replay, recordPath))
+        {
+            fprintf(stderr, "could not write replay %s\n", recordPath);
+            return 1;
+        }
+    }
+
+    printf("frames: %ld\n", frames);
+    printf("simulated time: %.1f s\n", frames / tickRate);
+    printf("wall time: %.3f s (%.0f frames/s)\n", seconds, frames / seconds);
+    printf("score: %d goals: %d\n", world.score, world.goals);
+    return 0;
+}
+
+int RunReplay(char const *path)
+{
+    Replay replay;
+    if (!LoadReplay(replay, path))
+    {
+        fprintf(stderr, "could not read replay %s\n", path);
+        return 1;
+    }
+
+    ReplayResult result = PlayReplay(replay);
+    printf("ticks: %d (%.0f ticks/s)\n", replay.TickCount, replay.TickCount / result.Seconds);
+    printf("recorded: score %d goals %d checksum %08x\n", replay.FinalScore, replay.FinalGoals, replay.FinalChecksum);
+    printf("replayed: score %d goals %d checksum %08x\n", result.Score, result.Goals, result.Checksum);
+    if (replay.Hashes.empty())
+    {
+        printf("no per-tick hashes in this replay, only the final state is compared\n");
+    }
+    else if (result.DivergedTick >= 0)
+    {
+        // The state at the start of the tick differs, so the tick before it stepped differently
+        printf("first divergence: start of tick %d (%.3f s in), fields:", result.DivergedTick,
+               result.DivergedTick / replay.TickRate);
+        for (int field = 0; field < STATE_FIELD_COUNT; field++)
+        {
+            if (result.DivergedFields & (1u << field))
+            {
+                printf(" %s", StateFieldName(field));
+            }
+        }
+        printf("%s\n", result.DivergedFields ? "" : " unknown");
+    }
+    printf("%s\n", result.Matches ? "match" : "MISMATCH");
+    return result.Matches ? 0 : 1;
+}
+
+int RunBatch(long frames, float tickRate, uint64_t seed, int worlds, int threads)
+{
+    float deltaTime = 1.0f / tickRate;
+    World templateWorld;
+    InitWorld(templateWorld, seed);
+
+    BatchWorlds batch;
+    InitBatch(batch, worlds, templateWorld, seed);
+    ThreadPool pool;
+    StartThreadPool(pool, threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long frame = 0; frame < frames; frame++)
+    {
+        RunParallel(pool, batch.Count, [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                batch.Input[i] = ScriptedBatchInput(batch, i);
+            }
+            StepBatchRange(batch, begin, end, deltaTime);
+        });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int threadCount = (int)pool.workers.size() + 1;
+    StopThreadPool(pool);
+
+    long long goals = 0;
+    long long score = 0;
+    for (int i = 0; i < batch.Count; i++)
+    {
+        goals += batch.Goals[i];
+        score += batch.Score[i];
+    }
+    double worldFrames = (double)frames * worlds;
+    printf("worlds: %d threads: %d frames: %ld\n", worlds, threadCount, frames);
+    printf("wall time: %.3f s (%.0f world-frames/s)\n", seconds, worldFrames / seconds);
+    printf("average score: %.1f average goals: %.2f\n", (double)score / worlds, (double)goals / worlds);
+    return 0;
+}
+
+// One world with extra balls, the keeper still follows world.ball
+int RunMultiBall(long frames, float tickRate, uint64_t seed, int balls, KeeperAi *ai, EventRing *events)
+{
+    float deltaTime = 1.0f / tickRate;
+    World world;
+    InitWorld(world, seed);
+    world.bricks = level;
+    world.events = events;
+    MultiBall multi;
+    InitMultiBall(multi, world, balls, seed);
+
+    long long pairTests = 0;
+    long long contacts = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long frame = 0; frame < frames; frame++)
+    {
+        SimInput input = ScriptedInput(world, ai, deltaTime);
+        Step(world, input, deltaTime);
+        if (world.GameOver && input.Restart)
+        {
+            ResetMultiBall(multi, world);
+        }
+        StepMultiBall(world, multi, deltaTime);
+        pairTests += multi.PairTests;
+        contacts += multi.Contacts;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("balls: %d + 1 frames: %ld\n", (int)multi.Balls.size(), frames);
+    printf("wall time: %.3f s (%.0f frames/s, %.0f ns per ball-frame)\n", seconds, frames / seconds,
+           seconds * 1e9 / frames / (multi.Balls.size() + 1));
+    printf("pair tests per frame: %.1f contacts per frame: %.2f\n", (double)pairTests / frames,
+           (double)contacts / frames);
+    printf("score: %d goals: %d\n", world.score, world.goals);
+    return 0;
+}
+
+int RunRender(float tickRate, uint64_t seed, std::vector<long> ticks, char const *dir, bool png, int width,
+              int height, KeeperAi *ai)
+{
+    float deltaTime = 1.0f / tickRate;
+    World world;
+    InitWorld(world, seed);
+    world.bricks = level;
+    // Effects only draw from effectsRng, the game plays out the same as without particles
+    ParticleStore particles = {};
+    world.particles = &particles;
+    Canvas canvas;
+    InitCanvas(canvas, width, height);
+
+    std::sort(ticks.begin(), ticks.end());
+    double renderSeconds = 0.0;
+    int written = 0;
+    size_t next = 0;
+    for (long tick = 0; next < ticks.size(); tick++)
+    {
+        for (; next < ticks.size() && ticks[next] == tick; next++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            // Particles spin by simulated time, the window spins them by GetTime()
+            RenderWorld(canvas, world, nullptr, 0, tick * deltaTime * 90);
+            renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            char path[512];
+            snprintf(path, sizeof(path), "%s/tick_%06ld.%s", dir, tick, png ? "png" : "ppm");
+            if (!(png ? WriteCanvasPng(canvas, path) : WriteCanvasPpm(canvas, path)))
+            {
+                fprintf(stderr, "could not write %s\n", path);
+                ReleaseParticleStore(particles);
+                return 1;
+            }
+            printf("%s\n", path);
+            written++;
+        }
+        Step(world, ScriptedInput(world, ai, deltaTime), deltaTime);
+    }
+    ReleaseParticleStore(particles);
+
+    if (written > 0)
+    {
+        printf("rendered %d frames at %dx%d, %.3f ms per frame\n", written, width, height,
+               renderSeconds * 1000 / written);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long frames = 10000000;
+    float tickRate = 60.0f;
+    uint64_t seed = 1;
+    char const *recordPath = nullptr;
+    char const *telemetryPath = nullptr;
+    int worlds = 0;
+    int threads = -1;
+    int balls = 0;
+    std::vector<long> renderTicks;
+    char const *renderDir = ".";
+    bool renderPng = true;
+    int renderWidth = (int)WORLD_WIDTH;
+    int renderHeight = (int)WORLD_HEIGHT;
+    int skill = -1;
+    for (int i = 1; i < argc; i += 2)
+    {
+        // Every option takes a value
+        if (i + 1 == argc)
+        {
+            fprintf(stderr, "%s wants a value\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--frames") == 0)
+        {
+            frames = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0)
+        {
+            tickRate = (float)atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            seed = strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--record") == 0)
+        {
+            recordPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--level") == 0)
+        {
+            if (!LoadBrickLevel(level, argv[i + 1]))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--telemetry") == 0)
+        {
+            telemetryPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--replay") == 0)
+        {
+            return RunReplay(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--batch") == 0)
+        {
+            worlds = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            // Total threads including the main one
+            threads = atoi(argv[i + 1]) - 1;
+            if (threads < 0)
+            {
+                fprintf(stderr, "--threads wants at least 1\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--balls") == 0)
+        {
+            balls = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--render") == 0)
+        {
+            // Comma separated
+            char *next = argv[i + 1];
+            do
+            {
+                renderTicks.push_back(strtol(next, &next, 10));
+            } while (*next++ == ',');
+        }
+        else if (strcmp(argv[i], "--ai") == 0)
+        {
+            skill = FindKeeperSkill(argv[i + 1]);
+            if (skill < 0)
+            {
+                fprintf(stderr, "--ai wants easy, normal, hard or perfect\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--render-dir") == 0)
+        {
+            renderDir = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--render-format") == 0)
+        {
+            renderPng = strcmp(argv[i + 1], "ppm") != 0;
+        }
+        else if (strcmp(argv[i], "--render-size") == 0)
+        {
+            if (sscanf(argv[i + 1], "%dx%d", &renderWidth, &renderHeight) != 2 || renderWidth <= 0 ||
+                renderHeight <= 0)
+            {
+                fprintf(stderr, "--render-size wants WIDTHxHEIGHT\n");
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    KeeperAi ai;
+    InitKeeperAi(ai, skill >= 0 ? skill : KEEPER_NORMAL, seed);
+    KeeperAi *keeperAi = skill >= 0 ? &ai : nullptr;
+    if (!renderTicks.empty())
+    {
+        return RunRender(tickRate, seed, renderTicks, renderDir, renderPng, renderWidth, renderHeight, keeperAi);
+    }
+
+    if (worlds > 0)
+    {
+        if (level.Columns > 0)
+        {
+            fprintf(stderr, "--batch has no bricks, it can't play --level\n");
+            return 1;
+        }
+        return RunBatch(frames, tickRate, seed, worlds, threads);
+    }
+
+    // Large ring, a headless run makes events much faster than real time
+    static EventWriter telemetry;
+    if (telemetryPath && !OpenEventWriter(telemetry, telemetryPath, 1 << 16, tickRate))
+    {
+        fprintf(stderr, "could not write events to %s\n", telemetryPath);
+        return 1;
+    }
+    EventRing *events = telemetryPath ? &telemetry.Ring : nullptr;
+    int result = balls > 0 ? RunMultiBall(frames, tickRate, seed, balls, keeperAi, events)
+                           : RunSingle(frames, tickRate, seed, recordPath, keeperAi, events);
+    if (events)
+    {
+        CloseEventWriter(telemetry);
+        printf("events: %lld written, %lld dropped\n", telemetry.Written, telemetry.Ring.Dropped);
+    }
+    return result;
+}
@@ -0,0 +1,75 @@
+#include "hud_text.h"
+#include <cstdio>
+#include <cstring>
+
+HudTextEntry const &PrepareHudText(HudTextCache &cache, int slot, char const *text, int fontSize)
+{
+    HudTextEntry &entry = cache.Entries[slot];
+    if (entry.Valid && entry.FontSize == fontSize && strcmp(entry.Text, text) == 0)
+    {
+        cache.Hits++;
+        return entry;
+    }
+
+    cache.Misses++;
+    snprintf(entry.Text, sizeof(entry.Text), "%s", text);
+    entry.FontSize = fontSize;
+    entry.Width = MeasureText(entry.Text, fontSize);
+
+    // Room to grow in steps of 64 pixels, so a score gaining a digit rarely needs a new texture
+    int width = (entry.Width / 64 + 1) * 64;
+    if (!IsRenderTextureValid(entry.Target) || entry.Target.texture.width < width ||
+        entry.Target.texture.height != fontSize)
+    {
+        if (IsRenderTextureValid(entry.Target))
+        {
+            UnloadRenderTexture(entry.Target);
+        }
+        entry.Target = LoadRenderTexture(width, fontSize);
+    }
+
+    BeginTextureMode(entry.Target);
+    ClearBackground(BLANK);
+    DrawText(entry.Text, 0, 0, fontSize, WHITE);
+    EndTextureMode();
+    entry.Valid = true;
+    return entry;
+}
+
+void DrawHudText(HudTextEntry const &entry, float x, float y, Color color)
+{
+    // Render textures are stored upside down
+    Rectangle source = {0, 0, (float)entry.Width, -(float)entry.FontSize};
+    DrawTextureRec(entry.Target.texture, source, {(float)(int)x, (float)(int)y}, color);
+}
+
+void DrawCachedText(HudTextCache &cache, int slot, char const *text, float x, float y, int fontSize, Color color)
+{
+    DrawHudText(PrepareHudText(cache, slot, text, fontSize), x, y, color);
+}
+
+void InvalidateHudText(HudTextCache &cache)
+{
+    for (int i = 0; i < HUD_SLOT_COUNT; i++)
+    {
+        cache.Entries[i].Valid = false;
+    }
+}
+
+void UnloadHudText(HudTextCache &cache)
+{
+    for (int i = 0; i < HUD_SLOT_COUNT; i++)
+    {
+        if (IsRenderTextureValid(cache.Entries[i].Target))
+        {
+            UnloadRenderTexture(cache.Entries[i].Target);
+        }
+        cache.Entries[i] = {};
+    }
+}
+
+float HudTextHitRate(HudTextCache const &cache)
+{
+    long long total = cache.Hits + cache.Misses;
+    return total > 0 ? (float)cache.Hits / total : 0.0f;
+}
@@ -0,0 +1,48 @@
+#ifndef HUD_TEXT_H
+#define HUD_TEXT_H
+
+#include "raylib.h"
+
+// Fixed HUD strings, one cache slot each
+enum HudSlot
+{
+    HUD_SCORE,
+    HUD_GOALS,
+    HUD_PAUSED,
+    HUD_GOAL,
+    HUD_MINUS50,
+    HUD_GAME_OVER,
+    HUD_RESTART,
+    HUD_REWIND,
+    HUD_SLOT_COUNT
+};
+
+int const HUD_TEXT_LENGTH = 64;
+
+// One string rasterized in white into a render texture, tinted when drawn.
+// The texture is only redrawn when the text or font size changes, and only reallocated when it grows.
+struct HudTextEntry
+{
+    char Text[HUD_TEXT_LENGTH];
+    int FontSize;
+    int Width; // MeasureText of Text
+    bool Valid;
+    RenderTexture2D Target;
+};
+
+struct HudTextCache
+{
+    HudTextEntry Entries[HUD_SLOT_COUNT];
+    long long Hits;
+    long long Misses;
+};
+
+// Brings the slot up to date with text and returns it. Counts a hit or a miss.
+HudTextEntry const &PrepareHudText(HudTextCache &cache, int slot, char const *text, int fontSize);
+void DrawHudText(HudTextEntry const &entry, float x, float y, Color color);
+void DrawCachedText(HudTextCache &cache, int slot, char const *text, float x, float y, int fontSize, Color color);
+void InvalidateHudText(HudTextCache &cache); // Redraw every slot on next use, e.g. after a resize
+void UnloadHudText(HudTextCache &cache);
+float HudTextHitRate(HudTextCache const &cache);
+
+#endif
@@ -0,0 +1,119 @@
+// Golden image check for headless renders.
+// Usage: footballArkanoid-imgdiff GOLDEN ACTUAL [--tolerance N] [--max-pixels N] [--diff FILE]
+// A pixel differs when any channel is off by more than --tolerance (default 0). Exits 0 when at most
+// --max-pixels pixels (default 0) differ, 1 when more do, 2 when an image can't be read, the sizes
+// differ or an option is unknown or has no value.
+// --diff writes a PPM with the golden image dimmed and every differing pixel in red.
+#include "canvas.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static int ChannelDifference(Color a, Color b)
+{
+    int r = abs(a.r - b.r);
+    int g = abs(a.g - b.g);
+    int blue = abs(a.b - b.b);
+    int alpha = abs(a.a - b.a);
+    int most = r > g ? r : g;
+    most = most > blue ? most : blue;
+    return most > alpha ? most : alpha;
+}
+
+static int Usage(char const *program)
+{
+    fprintf(stderr, "usage: %s GOLDEN ACTUAL [--tolerance N] [--max-pixels N] [--diff FILE]\n", program);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        return Usage(argv[0]);
+    }
+    char const *goldenPath = argv[1];
+    char const *actualPath = argv[2];
+    int tolerance = 0;
+    long maxPixels = 0;
+    char const *diffPath = nullptr;
+    for (int i = 3; i < argc; i += 2)
+    {
+        // A typo must not quietly turn a golden check into an exact one
+        if (i + 1 == argc)
+        {
+            fprintf(stderr, "%s wants a value\n", argv[i]);
+            return Usage(argv[0]);
+        }
+        if (strcmp(argv[i], "--tolerance") == 0)
+        {
+            tolerance = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--max-pixels") == 0)
+        {
+            maxPixels = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--diff") == 0)
+        {
+            diffPath = argv[i + 1];
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return Usage(argv[0]);
+        }
+    }
+
+    Canvas golden, actual;
+    if (!ReadCanvas(golden, goldenPath) || !ReadCanvas(actual, actualPath))
+    {
+        return 2;
+    }
+    if (golden.Width != actual.Width || golden.Height != actual.Height)
+    {
+        fprintf(stderr, "size differs: %dx%d golden, %dx%d actual\n", golden.Width, golden.Height, actual.Width,
+                actual.Height);
+        return 2;
+    }
+
+    Canvas diff;
+    InitCanvas(diff, golden.Width, golden.Height);
+    long differing = 0;
+    int worst = 0;
+    int left = golden.Width, top = golden.Height, right = -1, bottom = -1;
+    for (int y = 0; y < golden.Height; y++)
+    {
+        for (int x = 0; x < golden.Width; x++)
+        {
+            size_t i = (size_t)y * golden.Width + x;
+            int difference = ChannelDifference(golden.Pixels[i], actual.Pixels[i]);
+            worst = difference > worst ? difference : worst;
+            if (difference <= tolerance)
+            {
+                Color dim = golden.Pixels[i];
+                diff.Pixels[i] = (Color){(unsigned char)(dim.r / 4), (unsigned char)(dim.g / 4),
+                                         (unsigned char)(dim.b / 4), 255};
+                continue;
+            }
+            differing++;
+            diff.Pixels[i] = RED;
+            left = x < left ? x : left;
+            top = y < top ? y : top;
+            right = x > right ? x : right;
+            bottom = y > bottom ? y : bottom;
+        }
+    }
+
+    printf("%ld of %d pixels differ (tolerance %d), largest channel difference %d\n", differing,
+           golden.Width * golden.Height, tolerance, worst);
+    if (differing > 0)
+    {
+        printf("differences within x %d..%d, y %d..%d\n", left, right, top, bottom);
+    }
+    if (diffPath && !WriteCanvasPpm(diff, diffPath))
+    {
+        fprintf(stderr, "could not write %s\n", diffPath);
+    }
+    printf("%s\n", differing <= maxPixels ? "match" : "MISMATCH");
+    return differing <= maxPixels ? 0 : 1;
+}
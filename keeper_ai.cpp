@@ -0,0 +1,117 @@
+#include "keeper_ai.h"
+#include <cmath>
+#include <cstring>
+
+static KeeperSkill const KEEPER_SKILLS[KEEPER_SKILL_COUNT] = {
+    {0.35f, 2.0f, 0.25f, false},
+    {0.20f, 1.6f, 0.15f, true},
+    {0.10f, 1.2f, 0.10f, true},
+    {0.0f, 0.0f, 0.0f, true},
+};
+static char const *const KEEPER_SKILL_NAMES[KEEPER_SKILL_COUNT] = {"easy", "normal", "hard", "perfect"};
+
+KeeperSkill GetKeeperSkill(int level)
+{
+    return KEEPER_SKILLS[level];
+}
+
+char const *KeeperSkillName(int level)
+{
+    return KEEPER_SKILL_NAMES[level];
+}
+
+int FindKeeperSkill(char const *name)
+{
+    for (int i = 0; i < KEEPER_SKILL_COUNT; i++)
+    {
+        if (strcmp(name, KEEPER_SKILL_NAMES[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void InitKeeperAi(KeeperAi &ai, int level, uint64_t seed)
+{
+    ai = {};
+    ai.Skill = GetKeeperSkill(level);
+    SeedRng(ai.rng, seed);
+}
+
+float PredictBallY(Vector2 position, Vector2 direction, float radius, float targetX)
+{
+    float travel;
+    if (direction.x > 0.0f)
+    {
+        travel = targetX - position.x;
+    }
+    else if (direction.x < 0.0f)
+    {
+        // Out to the left wall and back
+        travel = (position.x - radius) + (targetX - radius);
+    }
+    else
+    {
+        return position.y;
+    }
+    if (travel <= 0.0f)
+    {
+        return position.y;
+    }
+
+    // Unfolded, the ball flies straight. Every span between the walls it crosses mirrors it once.
+    float top = radius;
+    float span = WORLD_HEIGHT - 2 * radius;
+    float unfolded = position.y - top + direction.y / fabsf(direction.x) * travel;
+    float folded = fmodf(unfolded, 2 * span);
+    if (folded < 0.0f)
+    {
+        folded += 2 * span;
+    }
+    return top + (folded <= span ? folded : 2 * span - folded);
+}
+
+SimInput KeeperAiInput(KeeperAi &ai, World const &world, float deltaTime)
+{
+    Ball const &ball = world.ball;
+    Goalkeeper const &keeper = world.keeper;
+
+    int slot = ai.Seen % KEEPER_AI_HISTORY;
+    ai.SeenPosition[slot] = ball.Position;
+    ai.SeenDirection[slot] = ball.Direction;
+    ai.SeenNormal[slot] = ball.State == Ball::NORMAL;
+    ai.Seen++;
+
+    // React to the ball as it was Latency ago
+    int delay = deltaTime > 0.0f ? (int)(ai.Skill.Latency / deltaTime + 0.5f) : 0;
+    delay = delay < KEEPER_AI_HISTORY - 1 ? delay : KEEPER_AI_HISTORY - 1;
+    delay = delay < ai.Seen - 1 ? delay : ai.Seen - 1;
+    int seen = (ai.Seen - 1 - delay) % KEEPER_AI_HISTORY;
+    Vector2 position = ai.SeenPosition[seen];
+    Vector2 direction = ai.SeenDirection[seen];
+    bool normal = ai.SeenNormal[seen];
+
+    // Kick-offs come from the center spot, wait in front of the goal for them
+    float target = WORLD_HEIGHT / 2;
+    if (normal)
+    {
+        float contactX = keeper.Position.x - keeper.Width / 2 - ball.Radius;
+        target = ai.Skill.Predicts ? PredictBallY(position, direction, ball.Radius, contactX) : position.y;
+    }
+
+    bool approaching = normal && direction.x > 0.0f;
+    if (approaching && !ai.Approaching)
+    {
+        ai.Aim = RandomFloat(ai.rng, -ai.Skill.AimError, ai.Skill.AimError);
+    }
+    ai.Approaching = approaching;
+    target += ai.Aim * keeper.Height / 2;
+
+    // At least half a tick of movement, or the keeper overshoots back and forth
+    float deadzone = fmaxf(ai.Skill.Deadzone * keeper.Height, keeper.Speed * deltaTime / 2);
+    SimInput input = {};
+    input.Up = target < keeper.Position.y - deadzone;
+    input.Down = target > keeper.Position.y + deadzone;
+    return input;
+}
@@ -0,0 +1,55 @@
+#ifndef KEEPER_AI_H
+#define KEEPER_AI_H
+
+#include "rng.h"
+#include "simulation.h"
+
+int const KEEPER_AI_HISTORY = 64; // Ticks of ball history, bounds the latency
+
+enum
+{
+    KEEPER_EASY,
+    KEEPER_NORMAL,
+    KEEPER_HARD,
+    KEEPER_PERFECT,
+    KEEPER_SKILL_COUNT
+};
+
+struct KeeperSkill
+{
+    float Latency;  // Seconds between the ball being somewhere and the keeper reacting to it
+    float AimError; // Largest miss of the intercept, in half keeper heights, rolled once per shot
+    float Deadzone; // Keeper heights of slack before moving, stops jitter
+    bool Predicts;  // false = chase the ball's current height instead of its intercept
+};
+
+// Computer goalkeeper, it only produces the Up/Down input a player would.
+// Plain data, so it copies with the world it plays in. Rewind snapshots leave it out: after a rewind the game
+// re-initializes it, reseeded from the world, and it starts again without any reaction history.
+struct KeeperAi
+{
+    KeeperSkill Skill;
+    Rng rng; // Aim errors, apart from the world's gameplay RNG
+
+    // What the keeper saw of the ball over the last ticks, oldest overwritten first
+    Vector2 SeenPosition[KEEPER_AI_HISTORY];
+    Vector2 SeenDirection[KEEPER_AI_HISTORY];
+    unsigned char SeenNormal[KEEPER_AI_HISTORY];
+    int Seen;
+
+    float Aim;        // Error of the current shot, in half keeper heights
+    bool Approaching; // Whether the ball was coming at the keeper last tick
+};
+
+KeeperSkill GetKeeperSkill(int level);
+char const *KeeperSkillName(int level);
+int FindKeeperSkill(char const *name); // -1 when there is no such level
+void InitKeeperAi(KeeperAi &ai, int level, uint64_t seed);
+// Input for the next tick of world, only Up and Down are ever set
+SimInput KeeperAiInput(KeeperAi &ai, World const &world, float deltaTime);
+
+// Height at which a ball next crosses x = targetX, without stepping it: the top and bottom wall
+// bounces fold the straight line back into the pitch, a ball moving away bounces off the left wall first
+float PredictBallY(Vector2 position, Vector2 direction, float radius, float targetX);
+
+#endif
@@ -0,0 +1,64 @@
+#include "latency.h"
+#include <algorithm>
+
+void ResetLatencyMeter(LatencyMeter &meter)
+{
+    meter = {};
+}
+
+void MarkInputRead(LatencyMeter &meter, double pollTime)
+{
+    // Frames without a new poll read the same input again, that isn't a new sample interval
+    if (pollTime == meter.PollTime)
+    {
+        return;
+    }
+    meter.PreviousPollTime = meter.PollTime > 0.0 ? meter.PollTime : pollTime;
+    meter.PollTime = pollTime;
+}
+
+void MarkPresent(LatencyMeter &meter, double presentTime)
+{
+    if (meter.PollTime <= 0.0)
+    {
+        return;
+    }
+    meter.PollToPresent[meter.Next] = (float)((presentTime - meter.PollTime) * 1000.0);
+    meter.PollInterval[meter.Next] = (float)((meter.PollTime - meter.PreviousPollTime) * 1000.0);
+    meter.Next = (meter.Next + 1) % LATENCY_FRAMES;
+    if (meter.Frames < LATENCY_FRAMES)
+    {
+        meter.Frames++;
+    }
+}
+
+LatencyStats GetLatencyStats(LatencyMeter const &meter)
+{
+    LatencyStats stats = {};
+    if (meter.Frames == 0)
+    {
+        return stats;
+    }
+
+    float worst[LATENCY_FRAMES];
+    float presentSum = 0.0f, expectedSum = 0.0f;
+    for (int i = 0; i < meter.Frames; i++)
+    {
+        presentSum += meter.PollToPresent[i];
+        expectedSum += meter.PollToPresent[i] + meter.PollInterval[i] * 0.5f;
+        worst[i] = meter.PollToPresent[i] + meter.PollInterval[i];
+    }
+    stats.PollToPresent = presentSum / meter.Frames;
+    stats.Expected = expectedSum / meter.Frames;
+    stats.Worst = *std::max_element(worst, worst + meter.Frames);
+
+    // Nearest rank, as in the profiler
+    int rank = (int)(0.99f * meter.Frames);
+    if (rank >= meter.Frames)
+    {
+        rank = meter.Frames - 1;
+    }
+    std::nth_element(worst, worst + rank, worst + meter.Frames);
+    stats.P99Worst = worst[rank];
+    return stats;
+}
@@ -0,0 +1,33 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+int const LATENCY_FRAMES = 240;
+
+// Input-to-present latency over the last LATENCY_FRAMES presented frames. A frame's simulation reads the
+// input state of one poll, so a key pressed after the poll before that one reaches the screen when this
+// frame is presented. The OS doesn't timestamp key events for us, so a press is assumed equally likely
+// anywhere between the two polls. Times are seconds from any one clock.
+struct LatencyMeter
+{
+    double PollTime;         // Poll the current frame's simulation read
+    double PreviousPollTime; // Poll the frame before read
+    float PollToPresent[LATENCY_FRAMES]; // Milliseconds, ring buffer
+    float PollInterval[LATENCY_FRAMES];
+    int Next;
+    int Frames;
+};
+
+struct LatencyStats
+{
+    float PollToPresent; // Average
+    float Expected;      // Average input-to-present, poll to present plus half the time between polls
+    float Worst;         // A press just after the previous poll, the longest it can take
+    float P99Worst;
+};
+
+void ResetLatencyMeter(LatencyMeter &meter);
+void MarkInputRead(LatencyMeter &meter, double pollTime); // The simulation reads the state polled at pollTime
+void MarkPresent(LatencyMeter &meter, double presentTime);
+LatencyStats GetLatencyStats(LatencyMeter const &meter); // Zero until a frame was presented
+
+#endif
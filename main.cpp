@@ -1,501 +1,1321 @@
 #include "raylib.h"
-#include "raymath.h"
+#include "dirty_region.h"
+#include "event_writer.h"
+#include "fixed_step.h"
+#include "hud_text.h"
+#include "keeper_ai.h"
+#include "latency.h"
+#include "multi_ball.h"
+#include "net_transport.h"
+#include "particle_renderer.h"
+#include "profiler.h"
+#include "replay.h"
+#include "rollback.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "versus.h"
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 
-struct Ball
-{
-    Vector2 Position;
-    float Radius;
-    float Speed;
-    Vector2 Direction;
-    Color BallColor;
-    enum
-    {
-        NORMAL,
-        ROLLING,
-        SPARKING
-    } State;
-    float RollTimer;
-    float rollDirection;
-    float spinAngle;
-    float spinSpeed;
-    float sparkTimer;
-};
-struct Ball ball = {.Position = {0.5f, 0.5f},
-                    .Radius = 0.008f,
-                    .Speed = 0.42f,
-                    .Direction = {1.0f, -1.0f},
-                    .BallColor = WHITE,
-                    .State = Ball::NORMAL,
-                    .RollTimer = 0.0f,
-                    .rollDirection = 0.0f,
-                    .spinAngle = 0.0f,
-                    .spinSpeed = 360.0f,
-                    .sparkTimer = 0.0f};
-
-struct Goalkeeper
-{
-    Vector2 Position;
-    float Width;
-    float Height;
-    float Speed;
-    Color KeeperColor;
-};
-struct Goalkeeper keeper = {
-    .Position = {0.96f, 0.5f}, .Width = 0.016f, .Height = 0.056f, .Speed = 0.485f, .KeeperColor = DARKBLUE};
+World world;
+ParticleStore particleStore;
+ParticleRenderer particleRenderer;
+bool batchParticles = true;   // F4 switches back to one DrawRectanglePro per particle
+bool showRenderStats = false; // F3
+RenderTexture2D fieldCache;   // Pitch and goal, redrawn only when the window size changes
+bool cacheField = true;       // F5 switches to drawing the pitch every frame
+FixedStep stepClock;
+Replay recording;
+char const *recordPath = nullptr; // --record FILE saves the inputs of this session on exit
+EventWriter telemetry;
+char const *telemetryPath = nullptr; // --telemetry FILE logs saves, goals, misses, pauses and restarts
+char const *levelPath = "resources/level.txt"; // --level FILE plays another brick level, --level none plays without
+FrameProfiler profiler;
+MultiBall multiBall; // --balls N adds N balls on top of world.ball
+EffectLibrary effects;
+HudTextCache hudText;
+bool cacheHudText = true; // F8 switches to DrawText every frame
+double nextEffectsCheck = 0.0;
+bool showProfiler = false; // F6, F7 writes profile.csv
+KeeperAi keeperAi;
+int keeperSkill = -1; // --ai SKILL or F10: the computer keeps goal (attract mode), -1 = the player does
+int const TARGET_FPS = 60;
 
-struct Goal
-{
-    Vector2 Position;
-    float Width;
-    float Height;
-    Color GoalColor;
-    Color NetColor;
-};
-struct Goal goal = {
-    .Position = {0.992f, 0.5f}, .Width = 0.024f, .Height = 0.308f, .GoalColor = GRAY, .NetColor = WHITE};
+// Holding Backspace plays the last --rewind SECONDS (default 10, 0 = off) backwards at REWIND_SPEED ticks
+// per tick. Play resumes from wherever it is let go, and a recording forgets the ticks that were undone.
+RewindBuffer rewindBuffer;
+float rewindSeconds = 10.0f;
+bool rewinding = false;
+int const REWIND_SPEED = 2;
+
+// Two-player mode. --versus plays both keepers on one keyboard, W/S on the left and the arrows on the right,
+// or the AI keeper of --ai on the left. --versus-net left|right PORT PEER_PORT plays one side against another
+// window over UDP with rollback, --net-latency/--net-jitter MS and --net-loss PERCENT make the link worse.
+bool versus = false;
+int netSide = -1;           // Side this window plays over the network, -1 = both sides are local
+VersusState versusState;    // Local game, or the latest predicted state of a network one
+VersusState previousVersus; // At the start of the last tick, drawn blended towards versusState
+RollbackSession rollback;
+NetTransport transport;
+
+// Power-save mode (--power-save, F9) for unattended screens: frames are patched only where something
+// changed, nothing is presented when nothing did, and a paused game sleeps until input arrives
+bool powerSave = false;
+RenderTexture2D retainedFrame; // Last presented frame, redrawn inside the damaged area only
+DirtyRegion damage;
+bool eventWaiting = false;
+double frameStart = 0.0;
+long long presentedFrames = 0;
+long long skippedFrames = 0;
 
-struct Particle
+// Low-latency mode (--low-latency, F11). raylib's pacing waits after presenting and polls input right after,
+// so what the player did reaches the screen a whole frame later. Instead sleep until just before the frame has
+// to start, poll, then simulate and present straight away.
+bool lowLatency = false;
+double latencyMargin = 0.002; // --latency-margin MS, slack on top of the measured frame work
+double workEstimate = 0.0;    // Poll to present of recent frames: peak held, slowly decaying
+double lastPollTime = 0.0;
+double lastPresentTime = 0.0;
+LatencyMeter latency;
+
+// Presses are collected after every poll and handled once per frame, IsKeyPressed forgets them at the next
+// poll and low-latency mode polls twice per frame
+int const WATCHED_KEYS[] = {KEY_SPACE, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11};
+unsigned int pressedKeys = 0; // Bit i: WATCHED_KEYS[i]
+bool restartPressed = false;
+
+// Screen-space bounds of what the last presented frame showed
+struct PresentedFrame
 {
-    Vector2 position;
-    Vector2 velocity;
-    Color color;
-    float alpha;
-    float size;
-    float life;
+    bool Valid;
+    int Width;
+    int Height;
+    Rectangle Ball;
+    float Spin;
+    Rectangle Keeper;
+    Rectangle Particles;
+    int Bricks;
+    std::vector<Rectangle> ExtraBalls;
+    int Hud[7]; // Everything the HUD text depends on
 };
-int const MAX_PARTICLES = 100;
-Particle particles[MAX_PARTICLES];
-int particleCount = 0;
-
-int score = 0;
-int goals = 0;
-bool Pause = false;
-bool SubtractScore = false;
-bool ShowMinus50 = false;
-float Minus50Timer = 0.0f;
-bool GameOver = false;
+PresentedFrame presented;
+
+// Positions at the start of the last tick, drawn blended towards the current ones
+Vector2 previousBallPos;
+Vector2 previousKeeperPos;
+std::vector<Ball> previousExtraBalls;
+float renderAlpha = 1.0f;
+
+// World-to-screen transform: uniform scale, pitch centered, letterboxed in black
+Camera2D worldView;
 
 // Declaration
 void DrawGame(void);
+void DrawRetainedGame(void);
+void DrawScene(void);
+void SkipFrame(void);
+void Present(void);
+void PaceFrame(void);
+void SetLowLatency(bool on);
+void FindDamage(void);
+void SetEventWaiting(bool wait);
+void UpdateFieldCache(void);
 void DrawFootballField(void);
 void DrawFootballBall(Vector2 position, float radius);
 void DrawGoalkeeper(Vector2 position, float width, float height);
 void DrawGoal(Vector2 position, float width, float height);
-void UpdateGame(float deltaTime);
-void BallWallCollision(void);
-void BallGoalkeeperCollision(void);
-void BallGoalCollision(void);
-void CreateGoalEffect(Vector2 goalPos);
-void CreateSparkEffect(Vector2 ballPos);
-void UpdateDrawParticles(float deltaTime);
-void UpdateBall(float deltaTime);
-void RestartGame(void);
-
-int main(void)
+void DrawBricks(void);
+void DrawParticles(void);
+void DrawStaticLayer(void);
+void DrawHud(void);
+void DrawHudString(int slot, char const *text, float x, float y, int fontSize, Color color, float anchor);
+void DrawProfilerOverlay(void);
+void UpdateWorldView(void);
+void RunTick(SimInput input, float deltaTime);
+void RewindTick(void);
+void VersusTick(SimInput input, float deltaTime);
+void ReceiveNetInputs(void);
+void DrawVersus(void);
+void DrawVersusHud(void);
+void DrawGameHud(void);
+Vector2 Interpolate(Vector2 previous, Vector2 current);
+Vector2 ExtraBallPosition(size_t index);
+float ParticleLag(void);
+Rectangle BallBounds(Vector2 position, float radius);
+Rectangle GoalkeeperBounds(Vector2 position, float width, float height);
+SimInput ReadInput(void);
+bool RestartClicked(void);
+void CollectKeyPresses(void);
+bool TakeKeyPress(int key);
+
+int main(int argc, char **argv)
 {
+    // Fixed 120 Hz ticks by default, --variable-step restores one step per rendered frame
+    stepClock = MakeFixedStep(120.0f, 5);
+    uint64_t seed = (uint64_t)time(nullptr);
+    int extraBalls = 0;
+    int netPort = 0;
+    int netPeerPort = 0;
+    char const *netPeer = nullptr;
+    LinkConditions netLink = {};
+    int inputDelay = 2;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--variable-step") == 0)
+        {
+            stepClock.Enabled = false;
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            stepClock = MakeFixedStep((float)atof(argv[++i]), stepClock.MaxSteps);
+        }
+        else if (strcmp(argv[i], "--max-steps") == 0 && i + 1 < argc)
+        {
+            stepClock.MaxSteps = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+        {
+            telemetryPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+        {
+            levelPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+        {
+            extraBalls = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rewind") == 0 && i + 1 < argc)
+        {
+            rewindSeconds = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--power-save") == 0)
+        {
+            powerSave = true;
+        }
+        else if (strcmp(argv[i], "--low-latency") == 0)
+        {
+            lowLatency = true;
+        }
+        else if (strcmp(argv[i], "--latency-margin") == 0 && i + 1 < argc)
+        {
+            latencyMargin = atof(argv[++i]) / 1000.0;
+        }
+        else if (strcmp(argv[i], "--versus") == 0)
+        {
+            versus = true;
+        }
+        else if (strcmp(argv[i], "--versus-net") == 0 && i + 3 < argc)
+        {
+            versus = true;
+            netSide = strcmp(argv[++i], "left") == 0 ? VERSUS_LEFT : VERSUS_RIGHT;
+            netPort = atoi(argv[++i]);
+            netPeerPort = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--peer") == 0 && i + 1 < argc)
+        {
+            netPeer = argv[++i];
+        }
+        else if (strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc)
+        {
+            netLink.Latency = (float)atof(argv[++i]) / 1000.0f;
+        }
+        else if (strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc)
+        {
+            netLink.Jitter = (float)atof(argv[++i]) / 1000.0f;
+        }
+        else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc)
+        {
+            netLink.Loss = (float)atof(argv[++i]) / 100.0f;
+        }
+        else if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc)
+        {
+            inputDelay = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--ai") == 0 && i + 1 < argc)
+        {
+            keeperSkill = FindKeeperSkill(argv[++i]);
+            if (keeperSkill < 0)
+            {
+                fprintf(stderr, "--ai wants easy, normal, hard or perfect\n");
+                return 1;
+            }
+        }
+        else
+        {
+            // Also a known option missing its value
+            fprintf(stderr,
+                    "unknown option %s\n"
+                    "usage: %s [--seed N] [--tick-rate HZ] [--max-steps N] [--variable-step] [--record FILE]\n"
+                    "       [--telemetry FILE] [--level FILE|none] [--balls N] [--rewind SECONDS] [--power-save]\n"
+                    "       [--low-latency] [--latency-margin MS] [--ai SKILL] [--versus]\n"
+                    "       [--versus-net left|right PORT PEER_PORT] [--peer HOST] [--net-latency MS]\n"
+                    "       [--net-jitter MS] [--net-loss PERCENT] [--input-delay TICKS]\n",
+                    argv[i], argv[0]);
+            return 1;
+        }
+    }
+    if (recordPath && !stepClock.Enabled)
+    {
+        // Variable steps can't be reproduced from inputs alone
+        printf("--record needs fixed steps, ignoring --variable-step\n");
+        stepClock.Enabled = true;
+    }
+    if (recordPath && extraBalls > 0)
+    {
+        // Replays only hold the inputs of a single-ball game
+        printf("--record is single-ball only, ignoring --balls\n");
+        extraBalls = 0;
+    }
+    if (versus && (recordPath || telemetryPath || extraBalls > 0 || powerSave || !stepClock.Enabled))
+    {
+        // Both sides have to step the same fixed ticks, and replays, events, multi-ball and damage tracking are
+        // single-player
+        printf("versus ignores --record, --telemetry, --balls, --power-save and --variable-step\n");
+        recordPath = nullptr;
+        telemetryPath = nullptr;
+        extraBalls = 0;
+        powerSave = false;
+        stepClock.Enabled = true;
+    }
+    if (versus)
+    {
+        rewindSeconds = 0.0f;
+    }
+    if (extraBalls > 0 && rewindSeconds > 0.0f)
+    {
+        // Snapshots hold world.ball only
+        printf("rewind is single-ball only, turned off with --balls\n");
+        rewindSeconds = 0.0f;
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(1250, 650, "Classic Game: Football Arkanoid");
-    SetTargetFPS(60);
+    SetLowLatency(lowLatency);
 
-    // Normalize ball direction
-    ball.Direction = Vector2Normalize(ball.Direction);
+    InitWorld(world, seed);
+    if (!versus && strcmp(levelPath, "none") != 0 && !LoadBrickLevel(world.bricks, levelPath))
+    {
+        printf("playing without bricks\n");
+    }
+    BeginReplay(recording, seed, stepClock.TickRate);
+    world.particles = &particleStore;
+    if (!LoadEffects(effects, "resources/effects.txt"))
+    {
+        printf("using built-in particle effects\n");
+        DefaultEffects(effects);
+    }
+    world.effects = &effects;
+    if (telemetryPath)
+    {
+        // Variable steps tick once per frame
+        if (OpenEventWriter(telemetry, telemetryPath, 4096, stepClock.Enabled ? stepClock.TickRate : TARGET_FPS))
+        {
+            world.events = &telemetry.Ring;
+        }
+        else
+        {
+            printf("could not write events to %s\n", telemetryPath);
+        }
+    }
+    InitMultiBall(multiBall, world, extraBalls, seed);
+    InitKeeperAi(keeperAi, keeperSkill >= 0 ? keeperSkill : KEEPER_NORMAL, seed);
+    // Variable steps tick once per frame, there the buffer covers about twice as long
+    InitRewindBuffer(rewindBuffer, (int)(rewindSeconds * stepClock.TickRate + 0.5f));
+    previousExtraBalls = multiBall.Balls;
+    InitVersus(versusState, seed);
+    if (netSide >= 0)
+    {
+        // Both windows need the same --seed
+        InitRollback(rollback, netSide, inputDelay, FixedStepDelta(stepClock), seed);
+        versusState = rollback.State;
+        if (!OpenTransport(transport, netPort, netPeer, netPeerPort, netLink, seed + netSide))
+        {
+            printf("could not open UDP port %d, playing both sides locally\n", netPort);
+            netSide = -1;
+        }
+    }
+    previousVersus = versusState;
+    LoadParticleRenderer(particleRenderer, 16384);
+    previousBallPos = world.ball.Position;
+    previousKeeperPos = world.keeper.Position;
 
+    // Key presses seen on frames without a tick wait for the next one
+    SimInput pending = {};
+    lastPollTime = GetTime();
     while (!WindowShouldClose())
     {
-        float deltaTime = GetFrameTime();
+        BeginProfileFrame(profiler);
+        if (lowLatency && !eventWaiting)
+        {
+            PaceFrame();
+        }
+        CollectKeyPresses();
+        MarkInputRead(latency, lastPollTime);
+        // Skipped frames never reach EndDrawing, so GetFrameTime() goes stale in power-save mode
+        double now = GetTime();
+        float frameTime = powerSave ? (float)(now - frameStart) : GetFrameTime();
+        if (eventWaiting)
+        {
+            // Time spent asleep waiting for input isn't game time
+            frameTime = fminf(frameTime, 1.0f / TARGET_FPS);
+        }
+        frameStart = now;
 
-        if (IsKeyPressed(KEY_SPACE))
+        if (GetTime() >= nextEffectsCheck)
         {
-            Pause = !Pause;
+            // Hot reload, a stat() twice a second is cheap enough
+            nextEffectsCheck = GetTime() + 0.5;
+            if (ReloadEffectsIfChanged(effects))
+            {
+                printf("reloaded %s\n", effects.Path);
+            }
+        }
+        SimInput input = ReadInput();
+        pending.TogglePause = pending.TogglePause || input.TogglePause;
+        pending.Restart = pending.Restart || input.Restart;
+        if (TakeKeyPress(KEY_F3))
+        {
+            showRenderStats = !showRenderStats;
+        }
+        if (TakeKeyPress(KEY_F4))
+        {
+            batchParticles = !batchParticles;
+        }
+        if (TakeKeyPress(KEY_F5))
+        {
+            cacheField = !cacheField;
+        }
+        if (TakeKeyPress(KEY_F6))
+        {
+            showProfiler = !showProfiler;
+        }
+        if (TakeKeyPress(KEY_F8))
+        {
+            cacheHudText = !cacheHudText;
+        }
+        if (TakeKeyPress(KEY_F9) && !versus)
+        {
+            powerSave = !powerSave;
+            presented.Valid = false;
+        }
+        if (TakeKeyPress(KEY_F10))
+        {
+            // Cycles easy, normal, hard, perfect, off
+            keeperSkill = keeperSkill + 1 < KEEPER_SKILL_COUNT ? keeperSkill + 1 : -1;
+            if (keeperSkill >= 0)
+            {
+                InitKeeperAi(keeperAi, keeperSkill, seed);
+            }
+            printf("AI keeper: %s\n", keeperSkill >= 0 ? KeeperSkillName(keeperSkill) : "off");
+        }
+        if (TakeKeyPress(KEY_F11))
+        {
+            SetLowLatency(!lowLatency);
+        }
+        if (TakeKeyPress(KEY_F7))
+        {
+            printf(WriteProfileCsv(profiler, "profile.csv") ? "wrote profile.csv (%d frames)\n"
+                                                            : "could not write profile.csv\n",
+                   profiler.Frames);
         }
 
-        if (score < 0)
+        int steps = AdvanceFixedStep(stepClock, frameTime);
+        rewinding = IsKeyDown(KEY_BACKSPACE) && rewindBuffer.Count > 0;
+        for (int i = 0; i < steps; i++)
         {
-            GameOver = true;
+            if (rewinding)
+            {
+                // Presses stay pending until play resumes
+                RewindTick();
+                continue;
+            }
+            if (versus)
+            {
+                input.TogglePause = pending.TogglePause;
+                input.Restart = pending.Restart;
+                pending = {};
+                VersusTick(input, FixedStepDelta(stepClock));
+                continue;
+            }
+            input.TogglePause = pending.TogglePause;
+            input.Restart = pending.Restart;
+            pending = {};
+            if (keeperSkill >= 0)
+            {
+                // Attract mode also restarts finished games by itself
+                SimInput ai = KeeperAiInput(keeperAi, world, FixedStepDelta(stepClock));
+                input.Up = ai.Up;
+                input.Down = ai.Down;
+                input.Restart = input.Restart || world.GameOver;
+            }
+            RunTick(input, FixedStepDelta(stepClock));
         }
+        renderAlpha = FixedStepAlpha(stepClock);
+        UpdateWorldView();
 
-        UpdateGame(deltaTime);
-        if (GameOver)
+        if (!powerSave)
+        {
+            SetEventWaiting(false);
+            DrawGame();
+        }
+        else
         {
-            RestartGame();
+            FindDamage();
+            // Paused or over with nothing left to animate, only input can change the picture
+            SetEventWaiting(!damage.Any && (world.Pause || world.GameOver));
+            if (damage.Any)
+            {
+                DrawRetainedGame();
+            }
+            else
+            {
+                SkipFrame();
+            }
         }
-        BallWallCollision();
-        BallGoalkeeperCollision();
-        BallGoalCollision();
+        EndProfileFrame(profiler);
+    }
 
-        DrawGame();
+    if (recordPath)
+    {
+        FinishReplay(recording, world);
+        if (!SaveReplay(recording, recordPath))
+        {
+            printf("could not write replay %s\n", recordPath);
+        }
     }
 
+    if (world.events)
+    {
+        CloseEventWriter(telemetry);
+        if (telemetry.Ring.Dropped > 0)
+        {
+            printf("%lld events dropped, the log writer fell behind\n", telemetry.Ring.Dropped);
+        }
+    }
+    if (netSide >= 0)
+    {
+        CloseTransport(transport);
+    }
+    UnloadParticleRenderer(particleRenderer);
+    UnloadHudText(hudText);
+    ReleaseParticleStore(particleStore);
+    if (IsRenderTextureValid(fieldCache))
+    {
+        UnloadRenderTexture(fieldCache);
+    }
+    if (IsRenderTextureValid(retainedFrame))
+    {
+        UnloadRenderTexture(retainedFrame);
+    }
     CloseWindow();
     return 0;
 }
 
-void UpdateGame(float deltaTime)
+void RunTick(SimInput input, float deltaTime)
 {
-    if (Pause || GameOver)
+    previousBallPos = world.ball.Position;
+    previousKeeperPos = world.keeper.Position;
+    int previousState = world.ball.State;
+    previousExtraBalls = multiBall.Balls;
+    bool wasGameOver = world.GameOver;
+
+    if (recordPath)
     {
-        return;
+        RecordReplayTick(recording, world, input);
+    }
+    PushRewind(rewindBuffer, world);
+    // Same as Step, split up so each part shows in the profiler
+    {
+        ProfileScope scope(profiler, PHASE_UPDATE);
+        StepRules(world, input, deltaTime);
+        if (wasGameOver && !world.GameOver)
+        {
+            ResetMultiBall(multiBall, world);
+        }
+    }
+    {
+        ProfileScope scope(profiler, PHASE_COLLISIONS);
+        StepCollisions(world);
+        StepMultiBall(world, multiBall, deltaTime);
+    }
+    {
+        ProfileScope scope(profiler, PHASE_PARTICLES);
+        UpdateParticles(world, deltaTime);
     }
 
-    if (SubtractScore)
+    // Kick-offs and goals teleport the ball, don't smear it across the pitch
+    if (world.ball.State != previousState)
     {
-        score -= 50;
-        SubtractScore = false;
+        previousBallPos = world.ball.Position;
     }
+}
+
+void RewindTick(void)
+{
+    previousBallPos = world.ball.Position;
+    previousKeeperPos = world.keeper.Position;
+    int previousState = world.ball.State;
 
-    if (ShowMinus50)
+    int ticks = Rewind(rewindBuffer, world, REWIND_SPEED);
+    if (recordPath)
+    {
+        TruncateReplay(recording, recording.TickCount - ticks);
+    }
+    if (keeperSkill >= 0)
     {
-        Minus50Timer -= deltaTime;
-        if (Minus50Timer <= 0.0f)
+        // What the AI keeper remembers seeing hasn't happened yet
+        InitKeeperAi(keeperAi, keeperSkill, world.rng.s[0]);
+    }
+
+    if (world.ball.State != previousState)
+    {
+        previousBallPos = world.ball.Position;
+    }
+}
+
+void VersusTick(SimInput input, float deltaTime)
+{
+    previousVersus = versusState;
+    int aiSide = netSide >= 0 ? netSide : VERSUS_LEFT;
+    SimInput ai = {};
+    if (keeperSkill >= 0)
+    {
+        World view;
+        VersusSideView(versusState, aiSide, view);
+        ai = KeeperAiInput(keeperAi, view, deltaTime);
+        ai.Restart = view.GameOver;
+    }
+
+    if (netSide < 0)
+    {
+        SimInput inputs[2] = {};
+        inputs[VERSUS_RIGHT] = input;
+        inputs[VERSUS_LEFT].Up = IsKeyDown(KEY_W);
+        inputs[VERSUS_LEFT].Down = IsKeyDown(KEY_S);
+        if (keeperSkill >= 0)
         {
-            ShowMinus50 = false;
+            inputs[VERSUS_LEFT] = ai;
         }
+        StepVersus(versusState, inputs, deltaTime);
+        return;
     }
 
-    // Update Goalkeeper
-    Vector2 keeperPixelPos = {keeper.Position.x * GetScreenWidth(), keeper.Position.y * GetScreenHeight()};
-    if (IsKeyDown(KEY_UP) && keeperPixelPos.y - keeper.Height * GetScreenHeight() / 2 > 0)
+    // Either key set moves this window's keeper
+    input.Up = input.Up || IsKeyDown(KEY_W);
+    input.Down = input.Down || IsKeyDown(KEY_S);
+    if (keeperSkill >= 0)
     {
-        keeper.Position.y -= keeper.Speed * deltaTime;
+        input.Up = ai.Up;
+        input.Down = ai.Down;
+        input.Restart = input.Restart || ai.Restart;
     }
-    if (IsKeyDown(KEY_DOWN) && keeperPixelPos.y + keeper.Height * GetScreenHeight() / 2 < GetScreenHeight())
+    ReceiveNetInputs();
+    if (AdvanceRollback(rollback, input))
+    {
+        versusState = rollback.State;
+    }
+    // Sent on stalls too, the other side may be waiting for our acknowledgement
+    InputMessage message;
+    MakeInputMessage(rollback, message);
+    unsigned char packet[INPUT_MESSAGE_SIZE];
+    SendPacket(transport, packet, WriteInputMessage(message, packet), GetTime());
+    FlushTransport(transport, GetTime());
+}
+
+void ReceiveNetInputs(void)
+{
+    unsigned char packet[NET_MAX_PACKET];
+    int size;
+    while ((size = ReceivePacket(transport, packet, sizeof(packet))) > 0)
     {
-        keeper.Position.y += keeper.Speed * deltaTime;
+        InputMessage message;
+        if (ReadInputMessage(message, packet, size))
+        {
+            ReceiveInputMessage(rollback, message);
+        }
     }
+}
 
-    UpdateBall(deltaTime);
+Vector2 Interpolate(Vector2 previous, Vector2 current)
+{
+    return {previous.x + (current.x - previous.x) * renderAlpha, previous.y + (current.y - previous.y) * renderAlpha};
 }
 
-void RestartGame(void)
+Vector2 ExtraBallPosition(size_t index)
+{
+    Ball const &ball = multiBall.Balls[index];
+    Ball const &previous = previousExtraBalls[index];
+    Vector2 from = previous.State == ball.State ? previous.Position : ball.Position;
+    return Interpolate(from, ball.Position);
+}
+
+SimInput ReadInput(void)
+{
+    SimInput input = {};
+    input.Up = IsKeyDown(KEY_UP);
+    input.Down = IsKeyDown(KEY_DOWN);
+    input.TogglePause = TakeKeyPress(KEY_SPACE);
+    input.Restart = restartPressed;
+    restartPressed = false;
+    return input;
+}
+
+bool RestartClicked(void)
 {
     Rectangle RestartButton = {GetScreenWidth() / 2.0f - 100, GetScreenHeight() / 2.0f + 50, 200, 50};
 
     Vector2 MousePoint = GetMousePosition();
-    if (CheckCollisionPointRec(MousePoint, RestartButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+    return CheckCollisionPointRec(MousePoint, RestartButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+}
+
+void CollectKeyPresses(void)
+{
+    for (int i = 0; i < (int)(sizeof(WATCHED_KEYS) / sizeof(WATCHED_KEYS[0])); i++)
     {
-        // Reset game
-        score = 0;
-        goals = 0;
-        ball = {.Position = {0.5f, 0.5f},
-                .Radius = 0.008f,
-                .Speed = 0.42f,
-                .Direction = {1.0f, -1.0f},
-                .BallColor = WHITE,
-                .State = Ball::NORMAL,
-                .RollTimer = 0.0f,
-                .rollDirection = 0.0f,
-                .spinAngle = 0.0f,
-                .spinSpeed = 360.0f,
-                .sparkTimer = 0.0f};
-        ball.Direction = Vector2Normalize(ball.Direction);
-        keeper = {
-            .Position = {0.96f, 0.5f}, .Width = 0.016f, .Height = 0.056f, .Speed = 0.485f, .KeeperColor = DARKBLUE};
-        particleCount = 0;
-        GameOver = false;
+        if (IsKeyPressed(WATCHED_KEYS[i]))
+        {
+            pressedKeys |= 1u << i;
+        }
     }
+    restartPressed = restartPressed || RestartClicked();
 }
 
-void CreateGoalEffect(Vector2 goalPos)
+// Whether key was pressed since it was last taken
+bool TakeKeyPress(int key)
 {
-    int particlesPerBlock = 4;
-    for (int i = 0; i < 8; i++)
+    for (int i = 0; i < (int)(sizeof(WATCHED_KEYS) / sizeof(WATCHED_KEYS[0])); i++)
     {
-        for (int p = 0; p < particlesPerBlock && particleCount < MAX_PARTICLES; p++)
+        if (WATCHED_KEYS[i] == key)
         {
-            Particle &particle = particles[particleCount];
-            particle.position = {goalPos.x * GetScreenWidth(), goalPos.y * GetScreenHeight()};
-            particle.velocity = {(float)(GetRandomValue(-200, 200)) / 100.0f,
-                                 (float)(GetRandomValue(-200, 200)) / 100.0f};
-            particle.color = MAROON;
-            particle.alpha = 1.0f;
-            particle.size = (float)GetRandomValue(5, 20);
-            particle.life = 0.5f + GetRandomValue(0, 150) / 100.0f;
-            particleCount++;
+            bool pressed = (pressedKeys >> i) & 1u;
+            pressedKeys &= ~(1u << i);
+            return pressed;
         }
     }
+    return false;
 }
 
-void CreateSparkEffect(Vector2 ballPos)
+// Particles move linearly, so they are drawn stepped back by the part of the tick not yet reached
+float ParticleLag(void)
 {
-    int sparkCount = 15;
-    for (int i = 0; i < sparkCount && particleCount < MAX_PARTICLES; i++)
-    {
-        Particle &particle = particles[particleCount];
-        particle.position = {ballPos.x * GetScreenWidth(), ballPos.y * GetScreenHeight()};
+    return (1.0f - renderAlpha) * FixedStepDelta(stepClock) * 120;
+}
 
-        float angle = GetRandomValue(0, 360) * DEG2RAD;
-        float speed = (float)GetRandomValue(50, 150) / 100.0f;
+void DrawParticles(void)
+{
+    float behind = ParticleLag();
+    if (batchParticles)
+    {
+        DrawParticleBatch(particleRenderer, particleStore, behind, GetTime() * 90, worldView);
+        return;
+    }
 
-        particle.velocity = {cosf(angle) * speed, sinf(angle) * speed};
-        particle.color = (Color){200, 220, 255, 255};
-        particle.alpha = 1.0f;
-        particle.size = (float)GetRandomValue(4, 10);
-        particle.life = 0.1f + GetRandomValue(0, 50) / 100.0f;
-        particleCount++;
+    BeginMode2D(worldView);
+    particleRenderer.drawCalls = particleStore.count;
+    for (int c = 0; c < particleStore.chunkCount; c++)
+    {
+        ParticleChunk const &p = *particleStore.chunks[c];
+        int chunkCount = ChunkParticleCount(particleStore, c);
+        for (int i = 0; i < chunkCount; i++)
+        {
+            Color particleColor = p.color[i];
+            particleColor.a = (unsigned char)(fminf(fmaxf(p.alpha[i], 0.0f), 1.0f) * p.color[i].a);
+            BeginBlendMode(p.blend[i]);
+            DrawRectanglePro({p.x[i] - p.vx[i] * behind, p.y[i] - p.vy[i] * behind, p.size[i], p.size[i]},
+                             {p.size[i] / 2, p.size[i] / 2}, GetTime() * 90, particleColor);
+        }
     }
+    EndBlendMode();
+    EndMode2D();
 }
 
-void UpdateDrawParticles(float deltaTime)
+void UpdateWorldView(void)
 {
-    for (int i = particleCount - 1; i >= 0; i--)
+    float scaleX = GetScreenWidth() / WORLD_WIDTH;
+    float scaleY = GetScreenHeight() / WORLD_HEIGHT;
+    worldView = {};
+    worldView.zoom = scaleX < scaleY ? scaleX : scaleY;
+    worldView.offset = {(GetScreenWidth() - WORLD_WIDTH * worldView.zoom) / 2,
+                        (GetScreenHeight() - WORLD_HEIGHT * worldView.zoom) / 2};
+}
+
+// Everything below draws in world units, inside BeginMode2D(worldView)
+void DrawFootballField(void)
+{
+    // Green pitch
+    DrawRectangleV({0, 0}, {WORLD_WIDTH, WORLD_HEIGHT}, (Color){0, 100, 0, 255});
+
+    // Center line
+    DrawRectangleV({WORLD_WIDTH / 2 - 2, 10}, {1, WORLD_HEIGHT - 22}, WHITE);
+
+    // Center circle
+    DrawCircleLinesV({WORLD_WIDTH / 2, WORLD_HEIGHT / 2}, WORLD_WIDTH * 0.072f, WHITE);
+
+    // Penalty area
+    float penaltyWidth = WORLD_WIDTH * 0.144f;
+    float penaltyHeight = world.goal.Height + WORLD_HEIGHT * 0.185f;
+    DrawRectangleLinesEx({WORLD_WIDTH - penaltyWidth - world.goal.Width + WORLD_WIDTH * 0.016f,
+                          WORLD_HEIGHT / 2 - penaltyHeight / 2, penaltyWidth, penaltyHeight},
+                         1, WHITE);
+    if (versus)
     {
-        Particle &p = particles[i];
-        p.position.x += p.velocity.x * deltaTime * 120;
-        p.position.y += p.velocity.y * deltaTime * 120;
-        p.life -= deltaTime;
-        p.alpha =
-            p.life / (p.color.r == 0 && p.color.g == 150 && p.color.b == 255 ? 0.5f : 1.5f); // Adjust fade for sparks
+        DrawRectangleLinesEx({world.goal.Width - WORLD_WIDTH * 0.016f, WORLD_HEIGHT / 2 - penaltyHeight / 2,
+                              penaltyWidth, penaltyHeight},
+                             1, WHITE);
+    }
 
-        Color particleColor = p.color;
-        particleColor.a = (unsigned char)(p.alpha * 255);
-        DrawRectanglePro({p.position.x, p.position.y, p.size, p.size}, {p.size / 2, p.size / 2}, GetTime() * 90,
-                         particleColor);
+    // Outer boundary
+    DrawRectangleLinesEx({WORLD_WIDTH * 0.008f, WORLD_HEIGHT * 0.015f, WORLD_WIDTH - WORLD_WIDTH * 0.016f,
+                          WORLD_HEIGHT - WORLD_HEIGHT * 0.031f},
+                         1, WHITE);
+}
 
-        if (p.life <= 0)
-        {
-            particles[i] = particles[particleCount - 1];
-            particleCount--;
-        }
+void DrawFootballBall(Vector2 position, float radius)
+{
+    DrawCircleV(position, radius, world.ball.BallColor);
+    for (int i = 0; i < 5; i++)
+    {
+        float angle = (i * (360.0f / 5) + world.ball.spinAngle) * DEG2RAD;
+        Vector2 pentagonPos = {position.x + cosf(angle) * radius * 0.5f, position.y + sinf(angle) * radius * 0.5f};
+        DrawCircleV(pentagonPos, radius * 0.3f, BLACK);
     }
 }
 
-void UpdateBall(float deltaTime)
+void DrawGoalkeeper(Vector2 position, float width, float height)
+{
+    // Body
+    DrawRectangleRec(GoalkeeperBounds(position, width, height), world.keeper.KeeperColor);
+}
+
+Rectangle GoalkeeperBounds(Vector2 position, float width, float height)
+{
+    return {position.x - width / 2 - WORLD_WIDTH * 0.016f, position.y - height / 5, width, height};
+}
+
+Rectangle BallBounds(Vector2 position, float radius)
 {
-    // Update ball
-    if (ball.State == Ball::NORMAL)
+    return {position.x - radius, position.y - radius, radius * 2, radius * 2};
+}
+
+void DrawGoal(Vector2 position, float width, float height)
+{
+    // Goal posts
+    float left = position.x - width;
+    float top = position.y - height / 2;
+    DrawRectangleV({left, top}, {width, height}, world.goal.GoalColor);
+
+    // Net (grid of lines)
+    int netLines = 7;
+    float netSpacingX = width / netLines;
+    float netSpacingY = height / netLines;
+    for (int i = 1; i < netLines; i++)
     {
-        ball.Position.x += ball.Direction.x * ball.Speed * deltaTime;
-        ball.Position.y += ball.Direction.y * ball.Speed * deltaTime;
-        ball.spinAngle = 0.0f;
+        DrawLineV({left + i * netSpacingX, top}, {left + i * netSpacingX, top + height}, world.goal.NetColor);
+        DrawLineV({left, top + i * netSpacingY}, {position.x, top + i * netSpacingY}, world.goal.NetColor);
     }
-    else if (ball.State == Ball::ROLLING)
+}
+
+// World space, a small gap between neighbours keeps the grid readable
+void DrawBricks(void)
+{
+    BrickField const &bricks = world.bricks;
+    for (int row = 0; row < bricks.Rows; row++)
     {
-        ball.RollTimer -= deltaTime;
-        float reducedSpeed = ball.Speed * 0.2f;
-        float newY = ball.Position.y + ball.rollDirection * reducedSpeed * deltaTime;
+        for (int column = 0; column < bricks.Columns; column++)
+        {
+            if (HasBrick(bricks, column, row))
+            {
+                Rectangle rect = BrickRect(bricks, column, row);
+                DrawRectangleRec({rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2}, ORANGE);
+            }
+        }
+    }
+}
 
-        float goalTop = goal.Position.y - goal.Height / 2 + ball.Radius;
-        float goalBottom = goal.Position.y + goal.Height / 2 - ball.Radius;
-        if (newY < goalTop)
+void DrawStaticLayer(void)
+{
+    if (!cacheField)
+    {
+        BeginMode2D(worldView);
         {
-            newY = goalTop;
-            ball.rollDirection = 1.0f; // Reverse direction to move down
+            ProfileScope scope(profiler, PHASE_FIELD);
+            DrawFootballField();
         }
-        else if (newY > goalBottom)
         {
-            newY = goalBottom;
-            ball.rollDirection = -1.0f; // Reverse direction to move up
+            ProfileScope scope(profiler, PHASE_GOAL);
+            DrawGoal(world.goal.Position, world.goal.Width, world.goal.Height);
+            if (versus)
+            {
+                Goal const &left = versusState.goals[VERSUS_LEFT];
+                DrawGoal(left.Position, left.Width, left.Height);
+            }
         }
-        ball.Position.y = newY;
-
-        // Keep ball at goal's x-position
-        ball.Position.x = goal.Position.x - ball.Radius;
+        EndMode2D();
+        return;
+    }
 
-        ball.spinAngle += ball.spinSpeed * deltaTime;
+    // Render textures are stored upside down
+    ProfileScope scope(profiler, PHASE_FIELD);
+    DrawTextureRec(fieldCache.texture, {0, 0, (float)fieldCache.texture.width, -(float)fieldCache.texture.height},
+                   {0, 0}, WHITE);
+}
 
-        if (ball.spinAngle >= 360.0f)
+// Outside any BeginDrawing/BeginTextureMode, render targets don't nest
+void UpdateFieldCache(void)
+{
+    // Sizes, not IsWindowResized: a resize made while F5 had the cache off has to be caught up with later
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+    if (cacheField && (!IsRenderTextureValid(fieldCache) || fieldCache.texture.width != width ||
+                       fieldCache.texture.height != height))
+    {
+        if (IsRenderTextureValid(fieldCache))
         {
-            ball.spinAngle -= 360.0f;
+            UnloadRenderTexture(fieldCache);
         }
+        fieldCache = LoadRenderTexture(width, height);
 
-        if (ball.RollTimer <= 0.0f)
+        BeginTextureMode(fieldCache);
+        ClearBackground(BLACK);
+        BeginMode2D(worldView);
+        {
+            ProfileScope scope(profiler, PHASE_FIELD);
+            DrawFootballField();
+        }
         {
-            // Transition to SPARKING state
-            ball.Position = (Vector2){0.5f, 0.5f};
-            ball.State = Ball::SPARKING;
-            ball.sparkTimer = 1.0f; // 1-second sparking effect
-            CreateSparkEffect(ball.Position);
+            ProfileScope scope(profiler, PHASE_GOAL);
+            DrawGoal(world.goal.Position, world.goal.Width, world.goal.Height);
+            if (versus)
+            {
+                Goal const &left = versusState.goals[VERSUS_LEFT];
+                DrawGoal(left.Position, left.Width, left.Height);
+            }
         }
+        EndMode2D();
+        EndTextureMode();
+    }
+}
+
+void DrawGame(void)
+{
+    UpdateFieldCache();
+    BeginDrawing();
+    DrawScene();
+    Present();
+}
+
+// Power-save frame: patch the damaged area of the retained frame, then present all of it
+void DrawRetainedGame(void)
+{
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+    int x, y, w, h;
+    if (!DirtyScissor(damage, width, height, 2, x, y, w, h))
+    {
+        // Everything that changed is off screen
+        SkipFrame();
+        return;
     }
-    else if (ball.State == Ball::SPARKING)
+    if (!IsRenderTextureValid(retainedFrame) || retainedFrame.texture.width != width ||
+        retainedFrame.texture.height != height)
     {
-        ball.sparkTimer -= deltaTime;
-        if (ball.sparkTimer <= 0.0f)
+        if (IsRenderTextureValid(retainedFrame))
         {
-            // Transition back to NORMAL state
-            ball.State = Ball::NORMAL;
-            ball.Direction = (Vector2){-1.0f, (float)GetRandomValue(-100, 100) / 100.0f};
-            ball.Direction = Vector2Normalize(ball.Direction);
+            UnloadRenderTexture(retainedFrame);
         }
+        retainedFrame = LoadRenderTexture(width, height);
     }
+
+    UpdateFieldCache();
+    BeginTextureMode(retainedFrame);
+    BeginScissorMode(x, y, w, h);
+    DrawScene();
+    EndScissorMode();
+    EndTextureMode();
+
+    BeginDrawing();
+    DrawTextureRec(retainedFrame.texture, {0, 0, (float)width, -(float)height}, {0, 0}, WHITE);
+    Present();
+    presentedFrames++;
 }
 
-void BallWallCollision(void)
+// EndDrawing swaps buffers, waits out the frame unless low-latency mode paces it, and polls input
+void Present(void)
 {
-    // Ball-wall collision
-    Vector2 ballPixelPos = {ball.Position.x * GetScreenWidth(), ball.Position.y * GetScreenHeight()};
-    float ballRadiusPixels = ball.Radius * GetScreenWidth();
-    if (ballPixelPos.y + ballRadiusPixels >= GetScreenHeight() || ballPixelPos.y - ballRadiusPixels <= 0)
     {
-        ball.Direction.y = -ball.Direction.y;
-        ball.Position.y = (ballPixelPos.y + ballRadiusPixels >= GetScreenHeight() ? GetScreenHeight() - ballRadiusPixels
-                                                                                  : ballRadiusPixels) /
-                          GetScreenHeight();
+        ProfileScope scope(profiler, PHASE_PRESENT);
+        EndDrawing();
     }
-    if (ballPixelPos.x - ballRadiusPixels <= 0)
+    double now = GetTime();
+    if (lowLatency)
     {
-        ball.Direction.x = -ball.Direction.x;
-        ball.Position.x = ballRadiusPixels / GetScreenWidth();
+        // Nothing waits inside EndDrawing, so this is the work pacing has to leave room for
+        workEstimate = fmax(now - lastPollTime, workEstimate * 0.99);
     }
+    MarkPresent(latency, now);
+    lastPresentTime = now;
+    lastPollTime = now;
+}
 
-    if (ballPixelPos.x + ballRadiusPixels >= GetScreenWidth() && ball.State == Ball::NORMAL)
+// Sleeps until the frame's work, as measured lately, would only just finish at the next frame's deadline, then
+// samples input for it
+void PaceFrame(void)
+{
+    // Presses from the poll in EndDrawing, before the next poll hides them
+    CollectKeyPresses();
     {
-        ShowMinus50 = true;
-        Minus50Timer = 1.0f;
-        SubtractScore = true;
-        ball.Position = (Vector2){0.5f, 0.5f};
-        ball.State = Ball::SPARKING;
-        ball.sparkTimer = 1.0f; // 1-second sparking effect
-        CreateSparkEffect(ball.Position);
+        ProfileScope scope(profiler, PHASE_PRESENT);
+        double wake = lastPresentTime + 1.0 / TARGET_FPS - workEstimate - latencyMargin;
+        double now = GetTime();
+        if (wake > now)
+        {
+            WaitTime(wake - now);
+        }
     }
+    PollInputEvents();
+    lastPollTime = GetTime();
+}
+
+void SetLowLatency(bool on)
+{
+    // PaceFrame holds the frame rate instead of EndDrawing
+    lowLatency = on;
+    SetTargetFPS(on ? 0 : TARGET_FPS);
+    workEstimate = 0.0;
+    ResetLatencyMeter(latency);
 }
 
-void BallGoalkeeperCollision(void)
+void SkipFrame(void)
 {
-    // Ball-goalkeeper collision
-    Vector2 keeperPixelPos = {keeper.Position.x * GetScreenWidth(), keeper.Position.y * GetScreenHeight()};
-    Rectangle keeperRect = {keeperPixelPos.x - keeper.Width * GetScreenWidth() / 2,
-                            keeperPixelPos.y - keeper.Height * GetScreenHeight() / 2, keeper.Width * GetScreenWidth(),
-                            keeper.Height * GetScreenHeight()};
-    Vector2 ballPixelPos = {ball.Position.x * GetScreenWidth(), ball.Position.y * GetScreenHeight()};
-    if (CheckCollisionCircleRec(ballPixelPos, ball.Radius * GetScreenWidth(), keeperRect))
+    // What EndDrawing would do besides presenting: poll input and hold the frame rate
+    skippedFrames++;
+    PollInputEvents();
+    lastPollTime = GetTime();
+    double left = 1.0 / TARGET_FPS - (GetTime() - frameStart);
+    if (left > 0.0)
     {
-        ball.Direction.x = -ball.Direction.x;
-        ball.Position.x = (keeperPixelPos.x - keeper.Width * GetScreenWidth() / 2 - ball.Radius * GetScreenWidth()) /
-                          GetScreenWidth();
-        score += 100;
+        WaitTime(left);
     }
 }
 
-void BallGoalCollision(void)
+void SetEventWaiting(bool wait)
 {
-    // Ball-goal collision
-    Vector2 goalPixelPos = {goal.Position.x * GetScreenWidth(), goal.Position.y * GetScreenHeight()};
-    Rectangle goalRect = {goalPixelPos.x - goal.Width * GetScreenWidth(),
-                          goalPixelPos.y - goal.Height * GetScreenHeight() / 2, goal.Width * GetScreenWidth(),
-                          goal.Height * GetScreenHeight()};
-    Vector2 ballPixelPos = {ball.Position.x * GetScreenWidth(), ball.Position.y * GetScreenHeight()};
-    if (ball.State == Ball::NORMAL && CheckCollisionCircleRec(ballPixelPos, ball.Radius * GetScreenWidth(), goalRect))
+    if (wait != eventWaiting)
     {
-        goals++;
-        CreateGoalEffect(goal.Position);
-
-        ball.Position.x = goal.Position.x - ball.Radius;
-        ball.Position.y = goal.Position.y;
-        ball.State = Ball::ROLLING;
-        ball.RollTimer = 4.0f;
-        ball.rollDirection = (ball.Direction.y >= 0) ? 1.0f : -1.0f;
+        if (wait)
+        {
+            EnableEventWaiting();
+        }
+        else
+        {
+            DisableEventWaiting();
+        }
+        eventWaiting = wait;
     }
 }
 
-void DrawFootballField(void)
+// Compares this frame against the last presented one
+void FindDamage(void)
 {
-    // Green pitch
-    DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), (Color){0, 100, 0, 255});
-
-    // Center line
-    DrawRectangle(GetScreenWidth() / 2 - 2, 10, 1, GetScreenHeight() - 22, WHITE);
+    ClearDirtyRegion(damage);
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
 
-    // Center circle
-    DrawCircleLines(GetScreenWidth() / 2, GetScreenHeight() / 2, GetScreenWidth() * 0.072f, WHITE);
+    Rectangle ball =
+        WorldToScreenRect(BallBounds(Interpolate(previousBallPos, world.ball.Position), world.ball.Radius), worldView);
+    Rectangle keeper = WorldToScreenRect(GoalkeeperBounds(Interpolate(previousKeeperPos, world.keeper.Position),
+                                                          world.keeper.Width, world.keeper.Height),
+                                         worldView);
+    Rectangle particles = {0, 0, 0, 0};
+    if (particleStore.count > 0)
+    {
+        particles = WorldToScreenRect(ParticleBounds(particleStore, ParticleLag()), worldView);
+    }
+    std::vector<Rectangle> extraBalls(multiBall.Balls.size());
+    for (size_t i = 0; i < extraBalls.size(); i++)
+    {
+        extraBalls[i] = WorldToScreenRect(BallBounds(ExtraBallPosition(i), multiBall.Balls[i].Radius), worldView);
+    }
+    int hud[7] = {world.score,      world.goals,    world.Pause, world.ball.State == Ball::ROLLING,
+                  world.ShowMinus50, world.GameOver, rewinding};
 
-    // Penalty area
-    float penaltyWidth = GetScreenWidth() * 0.144f;
-    float penaltyHeight = goal.Height * GetScreenHeight() + GetScreenHeight() * 0.185f;
-    DrawRectangleLines(GetScreenWidth() - penaltyWidth - goal.Width * GetScreenWidth() + GetScreenWidth() * 0.016f,
-                       (float)GetScreenHeight() / 2 - penaltyHeight / 2, penaltyWidth, penaltyHeight, WHITE);
+    // HUD changes are rare, they and the live stats overlays repaint everything
+    if (!presented.Valid || presented.Width != width || presented.Height != height || IsWindowResized() ||
+        !IsRenderTextureValid(retainedFrame) || showRenderStats || showProfiler ||
+        memcmp(hud, presented.Hud, sizeof(hud)) != 0 || extraBalls.size() != presented.ExtraBalls.size())
+    {
+        MarkAllDirty(damage, width, height);
+    }
+    else
+    {
+        // Every ball shares the spin of world.ball
+        bool spun = world.ball.spinAngle != presented.Spin;
+        MarkMoved(damage, presented.Ball, ball);
+        MarkMoved(damage, presented.Keeper, keeper);
+        for (size_t i = 0; i < extraBalls.size(); i++)
+        {
+            MarkMoved(damage, presented.ExtraBalls[i], extraBalls[i]);
+            if (spun)
+            {
+                MarkDirty(damage, extraBalls[i]);
+            }
+        }
+        if (spun)
+        {
+            MarkDirty(damage, ball);
+        }
+        // Live particles spin and fade even in place
+        MarkDirty(damage, presented.Particles);
+        MarkDirty(damage, particles);
+        if (world.bricks.Live.Remaining != presented.Bricks)
+        {
+            MarkDirty(damage, WorldToScreenRect(world.bricks.Area, worldView));
+        }
+    }
 
-    // Outer boundary
-    DrawRectangleLines(GetScreenWidth() * 0.008f, GetScreenHeight() * 0.015f,
-                       GetScreenWidth() - GetScreenWidth() * 0.016f, GetScreenHeight() - GetScreenHeight() * 0.031f,
-                       WHITE);
+    presented.Valid = true;
+    presented.Width = width;
+    presented.Height = height;
+    presented.Ball = ball;
+    presented.Spin = world.ball.spinAngle;
+    presented.Keeper = keeper;
+    presented.Particles = particles;
+    presented.Bricks = world.bricks.Live.Remaining;
+    presented.ExtraBalls.swap(extraBalls);
+    memcpy(presented.Hud, hud, sizeof(hud));
 }
 
-void DrawFootballBall(Vector2 position, float radius)
+// The whole picture into the current render target
+void DrawScene(void)
 {
-    Vector2 pixelPos = {position.x * GetScreenWidth(), position.y * GetScreenHeight()};
-    DrawCircleV(pixelPos, radius * GetScreenWidth(), ball.BallColor);
-    for (int i = 0; i < 5; i++)
+    ClearBackground(BLACK);
+
+    DrawStaticLayer();
     {
-        float angle = (i * (360.0f / 5) + ball.spinAngle) * DEG2RAD;
-        Vector2 pentagonPos = {pixelPos.x + cosf(angle) * radius * GetScreenWidth() * 0.5f,
-                               pixelPos.y + sinf(angle) * radius * GetScreenWidth() * 0.5f};
-        DrawCircleV(pentagonPos, radius * GetScreenWidth() * 0.3f, BLACK);
+        ProfileScope scope(profiler, PHASE_SPRITES);
+        BeginMode2D(worldView);
+        if (versus)
+        {
+            DrawVersus();
+        }
+        else
+        {
+            DrawBricks();
+            DrawGoalkeeper(Interpolate(previousKeeperPos, world.keeper.Position), world.keeper.Width,
+                           world.keeper.Height);
+            DrawFootballBall(Interpolate(previousBallPos, world.ball.Position), world.ball.Radius);
+            for (size_t i = 0; i < multiBall.Balls.size(); i++)
+            {
+                DrawFootballBall(ExtraBallPosition(i), multiBall.Balls[i].Radius);
+            }
+        }
+        EndMode2D();
+    }
+    {
+        ProfileScope scope(profiler, PHASE_PARTICLES);
+        DrawParticles();
+    }
+    {
+        ProfileScope scope(profiler, PHASE_TEXT);
+        DrawHud();
     }
 }
 
-void DrawGoalkeeper(Vector2 position, float width, float height)
+// World space, both keepers and the ball of the versus game
+void DrawVersus(void)
 {
-    // Body
-    Vector2 pixelPos = {position.x * GetScreenWidth(), position.y * GetScreenHeight()};
-    DrawRectangle(pixelPos.x - width * GetScreenWidth() / 2 - GetScreenWidth() * 0.016f,
-                  pixelPos.y - height * GetScreenHeight() / 5, width * GetScreenWidth(), height * GetScreenHeight(),
-                  keeper.KeeperColor);
+    Goalkeeper const &right = versusState.keepers[VERSUS_RIGHT];
+    DrawGoalkeeper(Interpolate(previousVersus.keepers[VERSUS_RIGHT].Position, right.Position), right.Width,
+                   right.Height);
+
+    // The right keeper's drawing, mirrored
+    Goalkeeper const &left = versusState.keepers[VERSUS_LEFT];
+    Vector2 position = Interpolate(previousVersus.keepers[VERSUS_LEFT].Position, left.Position);
+    Rectangle bounds = GoalkeeperBounds({WORLD_WIDTH - position.x, position.y}, left.Width, left.Height);
+    bounds.x = WORLD_WIDTH - bounds.x - bounds.width;
+    DrawRectangleRec(bounds, left.KeeperColor);
+
+    // Serves teleport the ball
+    Ball const &ball = versusState.ball;
+    Ball const &previous = previousVersus.ball;
+    DrawFootballBall(Interpolate(previous.State == ball.State ? previous.Position : ball.Position, ball.Position),
+                     ball.Radius);
 }
 
-void DrawGoal(Vector2 position, float width, float height)
+// Screen space
+void DrawHud(void)
 {
-    // Goal posts
-    Vector2 pixelPos = {position.x * GetScreenWidth(), position.y * GetScreenHeight()};
-    DrawRectangle(pixelPos.x - width * GetScreenWidth(), pixelPos.y - height * GetScreenHeight() / 2,
-                  width * GetScreenWidth(), height * GetScreenHeight(), goal.GoalColor);
+    if (IsWindowResized())
+    {
+        InvalidateHudText(hudText);
+    }
 
-    // Net (grid of lines)
-    int netLines = 7;
-    float netSpacingX = width * GetScreenWidth() / netLines;
-    float netSpacingY = height * GetScreenHeight() / netLines;
-    for (int i = 1; i < netLines; i++)
+    if (versus)
+    {
+        DrawVersusHud();
+    }
+    else
     {
-        DrawLine(pixelPos.x - width * GetScreenWidth() + i * netSpacingX, pixelPos.y - height * GetScreenHeight() / 2,
-                 pixelPos.x - width * GetScreenWidth() + i * netSpacingX, pixelPos.y + height * GetScreenHeight() / 2,
-                 goal.NetColor);
-        DrawLine(pixelPos.x - width * GetScreenWidth(), pixelPos.y - height * GetScreenHeight() / 2 + i * netSpacingY,
-                 pixelPos.x, pixelPos.y - height * GetScreenHeight() / 2 + i * netSpacingY, goal.NetColor);
+        DrawGameHud();
+    }
+
+    if (showRenderStats)
+    {
+        LatencyStats input = GetLatencyStats(latency);
+        DrawText(TextFormat("Input to present: %.1f ms expected, %.1f ms p99 worst (poll to present %.1f ms)  "
+                            "low latency: %s (frame work %.1f ms + %.1f ms margin)",
+                            input.Expected, input.P99Worst, input.PollToPresent, lowLatency ? "on" : "off",
+                            workEstimate * 1000.0, latencyMargin * 1000.0),
+                 GetScreenWidth() * 0.008f, GetScreenHeight() - 80, 20, WHITE);
+        DrawText(TextFormat("Particles: %i (peak %i, %i KB pooled, %i dropped)  "
+                            "particle draw calls: %i (%s)  field: %s",
+                            particleStore.count, particleStore.highWater,
+                            (int)(particleStore.allocatedChunks * sizeof(ParticleChunk) / 1024), particleStore.dropped,
+                            particleRenderer.drawCalls, batchParticles ? "batched" : "immediate",
+                            cacheField ? "cached" : "direct"),
+                 GetScreenWidth() * 0.008f, GetScreenHeight() - 55, 20, WHITE);
+        DrawText(TextFormat("HUD text: %s, %.1f%% cache hits (%lli redraws)  power save: %s (%lli presented, "
+                            "%lli skipped)  AI keeper: %s",
+                            cacheHudText ? "cached" : "direct", HudTextHitRate(hudText) * 100, hudText.Misses,
+                            powerSave ? "on" : "off", presentedFrames, skippedFrames,
+                            keeperSkill >= 0 ? KeeperSkillName(keeperSkill) : "off"),
+                 GetScreenWidth() * 0.008f, GetScreenHeight() - 30, 20, WHITE);
+    }
+
+    if (showProfiler)
+    {
+        DrawProfilerOverlay();
     }
 }
 
-void DrawGame(void)
+// Score, goal and game over texts of the single-player game
+void DrawGameHud(void)
 {
-    BeginDrawing();
-    ClearBackground(BLACK);
-
-    DrawFootballField();
-    DrawGoal(goal.Position, goal.Width, goal.Height);
-    DrawGoalkeeper(keeper.Position, keeper.Width, keeper.Height);
-    DrawFootballBall(ball.Position, ball.Radius);
-    UpdateDrawParticles(GetFrameTime());
+    char line[HUD_TEXT_LENGTH];
+    snprintf(line, sizeof(line), "Score: %i", world.score);
+    DrawHudString(HUD_SCORE, line, GetScreenWidth() * 0.008f, GetScreenHeight() * 0.015f, 20, WHITE, 0.0f);
+    snprintf(line, sizeof(line), "Goals: %i", world.goals);
+    DrawHudString(HUD_GOALS, line, GetScreenWidth() * 0.008f, GetScreenHeight() * 0.062f, 20, WHITE, 0.0f);
 
-    DrawText(TextFormat("Score: %i", score), GetScreenWidth() * 0.008f, GetScreenHeight() * 0.015f, 20, WHITE);
-    DrawText(TextFormat("Goals: %i", goals), GetScreenWidth() * 0.008f, GetScreenHeight() * 0.062f, 20, WHITE);
+    if (world.Pause)
+    {
+        DrawHudString(HUD_PAUSED, "Game paused", GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f, 25, BLACK, 0.5f);
+    }
 
-    if (Pause)
+    if (rewinding)
     {
-        DrawText("Game paused", GetScreenWidth() / 2.0f - MeasureText("Game paused", 25) / 2.0f,
-                 GetScreenHeight() / 2.0f, 25, BLACK);
+        DrawHudString(HUD_REWIND, "<< Rewind", GetScreenWidth() / 2.0f, GetScreenHeight() * 0.015f, 20, YELLOW, 0.5f);
     }
 
-    if (ball.State == Ball::ROLLING)
+    if (world.ball.State == Ball::ROLLING)
     {
-        DrawText("Goal", (float)GetScreenWidth() / 2 + 250, (float)GetScreenHeight() / 2, 30, BLACK);
+        DrawHudString(HUD_GOAL, "Goal", (float)GetScreenWidth() / 2 + 250, (float)GetScreenHeight() / 2, 30, BLACK,
+                      0.0f);
     }
 
-    if (ShowMinus50)
+    if (world.ShowMinus50)
     {
-        DrawText("-50", GetScreenWidth() / 2.0f + 250, GetScreenHeight() / 2.0f, 25, BLACK);
+        DrawHudString(HUD_MINUS50, "-50", GetScreenWidth() / 2.0f + 250, GetScreenHeight() / 2.0f, 25, BLACK, 0.0f);
     }
 
-    if (GameOver)
+    if (world.GameOver)
     {
-        DrawText("Game Over", GetScreenWidth() / 2.0f - MeasureText("Game Over", 35) / 2.0f,
-                 GetScreenHeight() / 2.0f - 50, 35, MAROON);
+        DrawHudString(HUD_GAME_OVER, "Game Over", GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f - 50, 35, MAROON,
+                      0.5f);
 
         // Draw Restart button
+        static int const restartLabelWidth = MeasureText("Restart 🔄", 20);
+        Rectangle RestartButton = {GetScreenWidth() / 2.0f - 100, GetScreenHeight() / 2.0f + 50, 200, 50};
+        DrawRectangleRounded(RestartButton, 0.3f, 10, DARKBLUE);
+        DrawHudString(HUD_RESTART, "Restart", RestartButton.x + (RestartButton.width - restartLabelWidth) / 2,
+                      RestartButton.y + (RestartButton.height - 20) / 2, 20, BLACK, 0.0f);
+    }
+}
+
+void DrawVersusHud(void)
+{
+    char line[HUD_TEXT_LENGTH];
+    snprintf(line, sizeof(line), "%i : %i", versusState.Score[VERSUS_LEFT], versusState.Score[VERSUS_RIGHT]);
+    DrawHudString(HUD_SCORE, line, GetScreenWidth() / 2.0f, GetScreenHeight() * 0.015f, 30, WHITE, 0.5f);
+
+    if (versusState.Pause)
+    {
+        DrawHudString(HUD_PAUSED, "Game paused", GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f, 25, BLACK, 0.5f);
+    }
+
+    if (versusState.GameOver)
+    {
+        bool leftWon = versusState.Score[VERSUS_LEFT] > versusState.Score[VERSUS_RIGHT];
+        DrawHudString(HUD_GAME_OVER, leftWon ? "Left wins" : "Right wins", GetScreenWidth() / 2.0f,
+                      GetScreenHeight() / 2.0f - 50, 35, MAROON, 0.5f);
+
+        static int const restartLabelWidth = MeasureText("Restart 🔄", 20);
         Rectangle RestartButton = {GetScreenWidth() / 2.0f - 100, GetScreenHeight() / 2.0f + 50, 200, 50};
         DrawRectangleRounded(RestartButton, 0.3f, 10, DARKBLUE);
-        DrawText("Restart", RestartButton.x + (RestartButton.width - MeasureText("Restart 🔄", 20)) / 2,
-                 RestartButton.y + (RestartButton.height - 20) / 2, 20, BLACK);
+        DrawHudString(HUD_RESTART, "Restart", RestartButton.x + (RestartButton.width - restartLabelWidth) / 2,
+                      RestartButton.y + (RestartButton.height - 20) / 2, 20, BLACK, 0.0f);
     }
 
-    EndDrawing();
+    if (netSide >= 0 && showRenderStats)
+    {
+        RollbackStats const &stats = rollback.Stats;
+        DrawText(TextFormat("Rollback: playing %s, tick %i, %i ahead of the other side, %lli rollbacks "
+                            "(%lli ticks again, deepest %i)  %lli stalls  %lli packets dropped  %lli desyncs",
+                            netSide == VERSUS_LEFT ? "left" : "right", rollback.Tick,
+                            rollback.Tick - rollback.RemoteTicks, stats.Rollbacks, stats.ResimulatedTicks,
+                            stats.MaxDepth, stats.Stalls, transport.Dropped, stats.Desyncs),
+                 GetScreenWidth() * 0.008f, GetScreenHeight() - 105, 20, WHITE);
+    }
+}
+
+// anchor 0 puts x at the left edge of the text, 0.5 at its center
+void DrawHudString(int slot, char const *text, float x, float y, int fontSize, Color color, float anchor)
+{
+    // Cached text is rasterized with its own BeginTextureMode, which can't nest inside the retained frame's
+    if (!cacheHudText || powerSave)
+    {
+        DrawText(text, x - (anchor > 0.0f ? MeasureText(text, fontSize) * anchor : 0.0f), y, fontSize, color);
+        return;
+    }
+    HudTextEntry const &entry = PrepareHudText(hudText, slot, text, fontSize);
+    DrawHudText(entry, x - entry.Width * anchor, y, color);
+}
+
+void DrawProfilerOverlay(void)
+{
+    int fontSize = 16;
+    int rowHeight = fontSize + 4;
+    int width = 330;
+    int x = GetScreenWidth() - width - 10;
+    int y = 10;
+    DrawRectangle(x, y, width, rowHeight * (PHASE_COUNT + 1) + 10, Fade(BLACK, 0.7f));
+
+    x += 8;
+    y += 5;
+    DrawText(TextFormat("ms (%i frames)", profiler.Frames), x, y, fontSize, LIGHTGRAY);
+    DrawText("min", x + 150, y, fontSize, LIGHTGRAY);
+    DrawText("avg", x + 205, y, fontSize, LIGHTGRAY);
+    DrawText("p99", x + 260, y, fontSize, LIGHTGRAY);
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseStats stats = GetPhaseStats(profiler, i);
+        y += rowHeight;
+        Color color = i == PHASE_FRAME ? YELLOW : WHITE;
+        DrawText(PhaseName(i), x, y, fontSize, color);
+        DrawText(TextFormat("%.2f", stats.Min), x + 150, y, fontSize, color);
+        DrawText(TextFormat("%.2f", stats.Average), x + 205, y, fontSize, color);
+        DrawText(TextFormat("%.2f", stats.P99), x + 260, y, fontSize, color);
+    }
 }
@@ -0,0 +1,223 @@
+#include "multi_ball.h"
+#include <cmath>
+
+void InitMultiBall(MultiBall &multi, World const &world, int count, uint64_t seed)
+{
+    if (count < 0)
+    {
+        count = 0;
+    }
+    if (count > MAX_EXTRA_BALLS)
+    {
+        count = MAX_EXTRA_BALLS;
+    }
+    multi.Balls.assign(count, world.ball);
+    SeedRng(multi.rng, seed);
+    multi.Grid.CellSize = 2 * world.ball.Radius;
+    multi.Grid.Columns = (int)ceilf(WORLD_WIDTH / multi.Grid.CellSize);
+    multi.Grid.Rows = (int)ceilf(WORLD_HEIGHT / multi.Grid.CellSize);
+    ResetMultiBall(multi, world);
+}
+
+void ResetMultiBall(MultiBall &multi, World const &world)
+{
+    World fresh = world;
+    fresh.particles = nullptr;
+    ResetWorld(fresh);
+
+    // Spread over the left three quarters of the pitch, heading anywhere but straight up or down
+    float radius = fresh.ball.Radius;
+    for (Ball &ball : multi.Balls)
+    {
+        ball = fresh.ball;
+        ball.Position.x = (float)RandomRange(multi.rng, (int)(0.05f * WORLD_WIDTH), (int)(0.75f * WORLD_WIDTH));
+        ball.Position.y = (float)RandomRange(multi.rng, (int)radius, (int)(WORLD_HEIGHT - radius));
+        float angle = RandomRange(multi.rng, -60, 60) * DEG2RAD;
+        float side = RandomRange(multi.rng, 0, 1) ? 1.0f : -1.0f;
+        ball.Direction = BallHeading({side * cosf(angle), sinf(angle)});
+    }
+    multi.PairTests = 0;
+    multi.Contacts = 0;
+}
+
+static int GridCell(BallGrid const &grid, Vector2 position)
+{
+    int column = (int)(position.x / grid.CellSize);
+    int row = (int)(position.y / grid.CellSize);
+    column = column < 0 ? 0 : (column >= grid.Columns ? grid.Columns - 1 : column);
+    row = row < 0 ? 0 : (row >= grid.Rows ? grid.Rows - 1 : row);
+    return row * grid.Columns + column;
+}
+
+// Only balls in play are inserted, rolling and sparking balls don't collide with anything
+void BuildBallGrid(BallGrid &grid, MultiBall const &multi, Ball const &primary)
+{
+    int ballCount = (int)multi.Balls.size() + 1;
+    int cellCount = grid.Columns * grid.Rows;
+    grid.CellStart.assign(cellCount + 1, 0);
+    grid.BallCell.resize(ballCount);
+
+    for (int i = 0; i < ballCount; i++)
+    {
+        Ball const &ball = i < ballCount - 1 ? multi.Balls[i] : primary;
+        grid.BallCell[i] = ball.State == Ball::NORMAL ? GridCell(grid, ball.Position) : -1;
+        if (grid.BallCell[i] >= 0)
+        {
+            grid.CellStart[grid.BallCell[i] + 1]++;
+        }
+    }
+    for (int cell = 0; cell < cellCount; cell++)
+    {
+        grid.CellStart[cell + 1] += grid.CellStart[cell];
+    }
+
+    grid.Entries.resize(grid.CellStart[cellCount]);
+    std::vector<int> next(grid.CellStart.begin(), grid.CellStart.end() - 1);
+    for (int i = 0; i < ballCount; i++)
+    {
+        if (grid.BallCell[i] >= 0)
+        {
+            grid.Entries[next[grid.BallCell[i]]++] = i;
+        }
+    }
+}
+
+static bool CollideBalls(Ball &a, Ball &b)
+{
+    float dx = b.Position.x - a.Position.x;
+    float dy = b.Position.y - a.Position.y;
+    float reach = a.Radius + b.Radius;
+    float distanceSquared = dx * dx + dy * dy;
+    if (distanceSquared >= reach * reach)
+    {
+        return false;
+    }
+
+    float distance = sqrtf(distanceSquared);
+    Vector2 normal = distance > 0.0f ? (Vector2){dx / distance, dy / distance} : (Vector2){1.0f, 0.0f};
+
+    // Push both out by half the overlap
+    float push = (reach - distance) / 2;
+    a.Position.x -= normal.x * push;
+    a.Position.y -= normal.y * push;
+    b.Position.x += normal.x * push;
+    b.Position.y += normal.y * push;
+
+    // Each ball bounces off the other like off a wall, so every ball keeps the game's fixed speed
+    float along = a.Direction.x * normal.x + a.Direction.y * normal.y;
+    if (along > 0.0f)
+    {
+        a.Direction.x -= 2 * along * normal.x;
+        a.Direction.y -= 2 * along * normal.y;
+    }
+    along = b.Direction.x * normal.x + b.Direction.y * normal.y;
+    if (along < 0.0f)
+    {
+        b.Direction.x -= 2 * along * normal.x;
+        b.Direction.y -= 2 * along * normal.y;
+    }
+    return true;
+}
+
+// BallMissed only raises a flag, which would count two misses in the same tick as one
+static int TakeMiss(World &world)
+{
+    int missed = world.SubtractScore ? 1 : 0;
+    world.SubtractScore = false;
+    return missed;
+}
+
+void StepMultiBall(World &world, MultiBall &multi, float deltaTime)
+{
+    multi.PairTests = 0;
+    multi.Contacts = 0;
+    if (world.Pause || world.GameOver)
+    {
+        return;
+    }
+
+    // world.ball already moved in Step, its miss (if any) is charged on the next tick as usual
+    bool primaryMissed = world.SubtractScore;
+    world.SubtractScore = false;
+    int misses = 0;
+
+    int extraCount = (int)multi.Balls.size();
+    for (int i = 0; i < extraCount; i++)
+    {
+        UpdateBall(world, multi.Balls[i], deltaTime);
+        misses += TakeMiss(world);
+    }
+
+    // Ball-ball: each cell against itself and four of its neighbours, so every pair is visited once
+    BallGrid &grid = multi.Grid;
+    BuildBallGrid(grid, multi, world.ball);
+    int const neighbours[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    for (int row = 0; row < grid.Rows; row++)
+    {
+        for (int column = 0; column < grid.Columns; column++)
+        {
+            int cell = row * grid.Columns + column;
+            for (int a = grid.CellStart[cell]; a < grid.CellStart[cell + 1]; a++)
+            {
+                int first = grid.Entries[a];
+                Ball &ballA = first < extraCount ? multi.Balls[first] : world.ball;
+                for (int b = a + 1; b < grid.CellStart[cell + 1]; b++)
+                {
+                    int second = grid.Entries[b];
+                    multi.PairTests++;
+                    multi.Contacts += CollideBalls(ballA, second < extraCount ? multi.Balls[second] : world.ball);
+                }
+                for (int n = 0; n < 4; n++)
+                {
+                    int otherColumn = column + neighbours[n][0];
+                    int otherRow = row + neighbours[n][1];
+                    if (otherColumn < 0 || otherColumn >= grid.Columns || otherRow >= grid.Rows)
+                    {
+                        continue;
+                    }
+                    int other = otherRow * grid.Columns + otherColumn;
+                    for (int b = grid.CellStart[other]; b < grid.CellStart[other + 1]; b++)
+                    {
+                        int second = grid.Entries[b];
+                        multi.PairTests++;
+                        multi.Contacts += CollideBalls(ballA, second < extraCount ? multi.Balls[second] : world.ball);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < extraCount; i++)
+    {
+        BallWallCollision(world, multi.Balls[i]);
+        misses += TakeMiss(world);
+    }
+
+    // Keeper and goal: only the cells around them, grown by one cell for the pushes made above
+    BallArena arena = MakeBallArena(world);
+    float left = fminf(arena.Keeper.x, arena.Goal.x) - grid.CellSize;
+    float top = fminf(arena.Keeper.y, arena.Goal.y) - grid.CellSize;
+    float right = fmaxf(arena.Keeper.x + arena.Keeper.width, arena.Goal.x + arena.Goal.width) + grid.CellSize;
+    float bottom = fmaxf(arena.Keeper.y + arena.Keeper.height, arena.Goal.y + arena.Goal.height) + grid.CellSize;
+    int firstCell = GridCell(grid, {left, top});
+    int lastCell = GridCell(grid, {right, bottom});
+    for (int row = firstCell / grid.Columns; row <= lastCell / grid.Columns; row++)
+    {
+        for (int column = firstCell % grid.Columns; column <= lastCell % grid.Columns; column++)
+        {
+            int cell = row * grid.Columns + column;
+            for (int e = grid.CellStart[cell]; e < grid.CellStart[cell + 1]; e++)
+            {
+                int index = grid.Entries[e];
+                if (index < extraCount)
+                {
+                    BallGoalkeeperCollision(world, multi.Balls[index]);
+                    BallGoalCollision(world, multi.Balls[index]);
+                }
+            }
+        }
+    }
+
+    world.score -= 50 * misses;
+    world.SubtractScore = primaryMissed;
+}
@@ -0,0 +1,38 @@
+#ifndef MULTI_BALL_H
+#define MULTI_BALL_H
+
+#include "simulation.h"
+#include <vector>
+
+int const MAX_EXTRA_BALLS = 8192;
+
+// Uniform grid over the pitch, rebuilt every tick with a counting sort.
+// Cells are one ball diameter wide, so two touching balls are always in the same or in neighbouring cells.
+struct BallGrid
+{
+    float CellSize;
+    int Columns;
+    int Rows;
+    std::vector<int> CellStart; // Columns * Rows + 1 offsets into Entries
+    std::vector<int> Entries;   // Ball indices, sorted by cell
+    std::vector<int> BallCell;  // Cell of each ball, -1 when it is not in the grid
+};
+
+// Stress/party mode: extra balls on the same pitch, sharing the world's keeper, goal and score.
+// Every ball runs the UpdateBall state machine, balls in play also bounce off each other.
+struct MultiBall
+{
+    std::vector<Ball> Balls; // In the grid, index Balls.size() stands for world.ball
+    BallGrid Grid;
+    Rng rng;                 // Only used to spread the balls at kick-off
+    int PairTests;           // Ball-ball tests done in the last step
+    int Contacts;            // Ball-ball bounces in the last step
+};
+
+void InitMultiBall(MultiBall &multi, World const &world, int count, uint64_t seed);
+void ResetMultiBall(MultiBall &multi, World const &world); // Same count, new kick-off positions
+void StepMultiBall(World &world, MultiBall &multi, float deltaTime); // Call after Step, with the same delta
+
+void BuildBallGrid(BallGrid &grid, MultiBall const &multi, Ball const &primary);
+
+#endif
@@ -0,0 +1,147 @@
+#include "net_transport.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket close
+#endif
+
+bool OpenTransport(NetTransport &transport, int localPort, char const *peerHost, int peerPort, LinkConditions link,
+                   uint64_t seed)
+{
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        return false;
+    }
+#endif
+    transport.Socket = -1;
+    transport.Link = link;
+    SeedRng(transport.rng, seed);
+    transport.Queued = 0;
+    transport.Sent = 0;
+    transport.Dropped = 0;
+    transport.Received = 0;
+    transport.PeerAddress = inet_addr(peerHost ? peerHost : "127.0.0.1");
+    transport.PeerPort = htons((unsigned short)peerPort);
+
+    int fd = (int)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((unsigned short)localPort);
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    bool ready = ioctlsocket(fd, FIONBIO, &nonBlocking) == 0;
+#else
+    bool ready = fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ready || bind(fd, (sockaddr *)&local, sizeof(local)) != 0)
+    {
+        closesocket(fd);
+        return false;
+    }
+    transport.Socket = fd;
+    return true;
+}
+
+void CloseTransport(NetTransport &transport)
+{
+    if (transport.Socket >= 0)
+    {
+        closesocket(transport.Socket);
+        transport.Socket = -1;
+    }
+}
+
+void SendPacket(NetTransport &transport, void const *data, int size, double now)
+{
+    LinkConditions const &link = transport.Link;
+    if (size > NET_MAX_PACKET || transport.Queued == NET_QUEUE ||
+        (link.Loss > 0.0f && RandomFloat(transport.rng, 0.0f, 1.0f) < link.Loss))
+    {
+        transport.Dropped++;
+        return;
+    }
+    DelayedPacket &packet = transport.Queue[transport.Queued++];
+    packet.DueTime = now + link.Latency + (link.Jitter > 0.0f ? RandomFloat(transport.rng, 0.0f, link.Jitter) : 0.0f);
+    packet.Size = size;
+    memcpy(packet.Data, data, size);
+}
+
+void FlushTransport(NetTransport &transport, double now)
+{
+    sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = transport.PeerAddress;
+    peer.sin_port = transport.PeerPort;
+
+    // Due packets leave in queue order, the rest move up
+    int kept = 0;
+    for (int i = 0; i < transport.Queued; i++)
+    {
+        DelayedPacket &packet = transport.Queue[i];
+        if (packet.DueTime > now)
+        {
+            if (kept != i)
+            {
+                transport.Queue[kept] = packet;
+            }
+            kept++;
+            continue;
+        }
+        // A peer that isn't up yet is just another lost packet
+        if (sendto(transport.Socket, (char const *)packet.Data, packet.Size, 0, (sockaddr *)&peer, sizeof(peer)) ==
+            packet.Size)
+        {
+            transport.Sent++;
+        }
+        else
+        {
+            transport.Dropped++;
+        }
+    }
+    transport.Queued = kept;
+}
+
+int ReceivePacket(NetTransport &transport, void *data, int capacity)
+{
+    // Errors such as ICMP port unreachable from a peer that isn't listening yet don't end the session
+    for (int attempt = 0; attempt < 8; attempt++)
+    {
+        sockaddr_in from;
+        socklen_t fromSize = sizeof(from);
+        int size = (int)recvfrom(transport.Socket, (char *)data, capacity, 0, (sockaddr *)&from, &fromSize);
+        if (size > 0)
+        {
+            transport.Received++;
+            return size;
+        }
+        if (size == 0)
+        {
+            return 0;
+        }
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+#endif
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
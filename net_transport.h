@@ -0,0 +1,49 @@
+#ifndef NET_TRANSPORT_H
+#define NET_TRANSPORT_H
+
+#include "rng.h"
+
+int const NET_MAX_PACKET = 512;
+int const NET_QUEUE = 256; // Packets held back by the simulated link
+
+// Simulated network between the game and the socket, applied to outgoing packets
+struct LinkConditions
+{
+    float Latency; // Seconds, one way
+    float Jitter;  // Seconds, uniform on top of Latency, so packets can overtake each other
+    float Loss;    // Fraction of packets dropped
+};
+
+struct DelayedPacket
+{
+    double DueTime;
+    int Size;
+    unsigned char Data[NET_MAX_PACKET];
+};
+
+// Non-blocking UDP socket talking to one peer, by default on localhost
+struct NetTransport
+{
+    int Socket; // -1 when closed
+    unsigned int PeerAddress; // IPv4, network byte order
+    unsigned short PeerPort;  // Network byte order
+    LinkConditions Link;
+    Rng rng; // Jitter and loss
+    DelayedPacket Queue[NET_QUEUE];
+    int Queued;
+
+    long long Sent;
+    long long Dropped; // By the simulated link or a full queue
+    long long Received;
+};
+
+// peerHost is a dotted IPv4 address, null for 127.0.0.1
+bool OpenTransport(NetTransport &transport, int localPort, char const *peerHost, int peerPort, LinkConditions link,
+                   uint64_t seed);
+void CloseTransport(NetTransport &transport);
+// Hands a packet to the simulated link, it reaches the socket in FlushTransport once its delay is over
+void SendPacket(NetTransport &transport, void const *data, int size, double now);
+void FlushTransport(NetTransport &transport, double now);
+int ReceivePacket(NetTransport &transport, void *data, int capacity); // Size of the next packet, 0 when none
+
+#endif
@@ -0,0 +1,339 @@
+// Rollback netplay harness: two versus sides play over UDP through a simulated link and report what
+// rollback costs them.
+// Usage: footballArkanoid-netplay [--ticks N] [--tick-rate HZ] [--seed N] [--latency MS] [--jitter MS]
+//                                 [--loss PERCENT] [--delay TICKS] [--port N] [--ai SKILL] [--realtime]
+//        footballArkanoid-netplay --player left|right --port N --peer-port N [--peer IPV4] [same options]
+// Without --player both sides run in this process on localhost ports --port and --port + 1. The link then
+// follows the tick clock instead of the wall clock, so a run is as fast as the CPU and repeatable, unless
+// --realtime. Both sides are checked against a plain re-simulation of the inputs they played.
+// With --player one side plays in real time against another process, e.g. on a second terminal.
+// The keeper AI of --ai (default normal) plays both keepers, restarting finished games.
+#include "keeper_ai.h"
+#include "net_transport.h"
+#include "replay.h"
+#include "rollback.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+struct NetPeer
+{
+    RollbackSession Session;
+    NetTransport Transport;
+    KeeperAi Ai;
+    std::vector<unsigned char> Played; // Local input of every tick, for the reference run
+};
+
+struct NetOptions
+{
+    long Ticks;
+    float TickRate;
+    uint64_t Seed;
+    LinkConditions Link;
+    int InputDelay;
+    int Port;
+    int PeerPort;
+    char const *PeerHost;
+    int Skill;
+    bool Realtime;
+};
+
+static double WallClock(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool OpenPeer(NetPeer &peer, int side, NetOptions const &options, int port, int peerPort)
+{
+    InitRollback(peer.Session, side, options.InputDelay, 1.0f / options.TickRate, options.Seed);
+    InitKeeperAi(peer.Ai, options.Skill, options.Seed + side);
+    // Inputs of the ticks before the first local one are empty
+    peer.Played.assign(peer.Session.InputDelay, 0);
+    if (!OpenTransport(peer.Transport, port, options.PeerHost, peerPort, options.Link, options.Seed * 2 + side))
+    {
+        fprintf(stderr, "could not open UDP port %d\n", port);
+        return false;
+    }
+    return true;
+}
+
+static void ReceiveAll(NetPeer &peer)
+{
+    unsigned char buffer[NET_MAX_PACKET];
+    int size;
+    while ((size = ReceivePacket(peer.Transport, buffer, sizeof(buffer))) > 0)
+    {
+        InputMessage message;
+        if (ReadInputMessage(message, buffer, size))
+        {
+            ReceiveInputMessage(peer.Session, message);
+        }
+    }
+}
+
+static void SendState(NetPeer &peer, double now)
+{
+    InputMessage message;
+    MakeInputMessage(peer.Session, message);
+    unsigned char buffer[INPUT_MESSAGE_SIZE];
+    SendPacket(peer.Transport, buffer, WriteInputMessage(message, buffer), now);
+    FlushTransport(peer.Transport, now);
+}
+
+// One tick of one side: take in what arrived, play the AI's input, tell the other side
+static void TickPeer(NetPeer &peer, long ticks, double now)
+{
+    ReceiveAll(peer);
+    RollbackSession &session = peer.Session;
+    if (session.Tick < ticks)
+    {
+        World view;
+        VersusSideView(session.State, session.LocalSide, view);
+        SimInput input = KeeperAiInput(peer.Ai, view, session.DeltaTime);
+        input.Restart = view.GameOver;
+        if (AdvanceRollback(session, input))
+        {
+            peer.Played.push_back(PackInput(input));
+        }
+    }
+    else
+    {
+        ResolveRollback(session);
+    }
+    SendState(peer, now);
+}
+
+static bool Settled(NetPeer const &peer, long ticks)
+{
+    return peer.Session.Tick >= ticks && peer.Session.Confirmed >= ticks;
+}
+
+static void PrintStats(NetPeer const &peer, float tickRate)
+{
+    RollbackStats const &stats = peer.Session.Stats;
+    float seconds = stats.Ticks / tickRate;
+    printf("%-5s %9lld %11lld %8.1f %9d %9.2f %7lld %10.2f %7lld %7lld %7lld\n",
+           peer.Session.LocalSide == VERSUS_LEFT ? "left" : "right", stats.Rollbacks, stats.ResimulatedTicks,
+           seconds > 0.0f ? stats.ResimulatedTicks / seconds : 0.0f, stats.MaxDepth,
+           stats.Rollbacks > 0 ? (double)stats.ResimulatedTicks / stats.Rollbacks : 0.0, stats.Stalls,
+           stats.ResimulatedTicks > 0 ? stats.ResimulateSeconds * 1e6 / stats.ResimulatedTicks : 0.0,
+           peer.Transport.Sent, peer.Transport.Dropped, stats.Desyncs);
+    if (stats.FirstDesyncTick >= 0)
+    {
+        printf("      desync: states agreed at tick %d, differed at tick %d\n", stats.LastAgreedTick,
+               stats.FirstDesyncTick);
+    }
+}
+
+static void PrintHeader(NetOptions const &options)
+{
+    printf("ticks: %ld (%.1f s at %.0f Hz), link %.0f ms + %.0f ms jitter, %.1f%% loss, input delay %d\n",
+           options.Ticks, options.Ticks / options.TickRate, options.TickRate, options.Link.Latency * 1000.0f,
+           options.Link.Jitter * 1000.0f, options.Link.Loss * 100.0f, options.InputDelay);
+    printf("side  rollbacks resim ticks  resim/s max depth avg depth  stalls us/resim    sent dropped desyncs\n");
+}
+
+// The inputs both sides played, simulated without any rollback
+static uint32_t ReferenceChecksum(NetPeer const peers[2], NetOptions const &options)
+{
+    VersusState state;
+    InitVersus(state, options.Seed);
+    for (long t = 0; t < options.Ticks; t++)
+    {
+        SimInput inputs[2] = {UnpackInput(peers[VERSUS_LEFT].Played[t]), UnpackInput(peers[VERSUS_RIGHT].Played[t])};
+        StepVersus(state, inputs, 1.0f / options.TickRate);
+    }
+    return VersusChecksum(state);
+}
+
+static int RunLoopback(NetOptions const &options)
+{
+    static NetPeer peers[2];
+    for (int side = 0; side < 2; side++)
+    {
+        if (!OpenPeer(peers[side], side, options, options.Port + side, options.Port + 1 - side))
+        {
+            return 1;
+        }
+    }
+
+    // Past the last tick the sides keep talking until everything is confirmed, for at most 10 s
+    double deltaTime = 1.0 / options.TickRate;
+    long limit = options.Ticks + (long)(10.0 * options.TickRate);
+    double start = WallClock();
+    long step = 0;
+    for (; step < limit && !(Settled(peers[0], options.Ticks) && Settled(peers[1], options.Ticks)); step++)
+    {
+        double now = options.Realtime ? WallClock() - start : step * deltaTime;
+        TickPeer(peers[VERSUS_LEFT], options.Ticks, now);
+        TickPeer(peers[VERSUS_RIGHT], options.Ticks, now);
+        if (options.Realtime)
+        {
+            double wait = (step + 1) * deltaTime - (WallClock() - start);
+            if (wait > 0.0)
+            {
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+            }
+        }
+    }
+    double seconds = WallClock() - start;
+
+    PrintHeader(options);
+    PrintStats(peers[VERSUS_LEFT], options.TickRate);
+    PrintStats(peers[VERSUS_RIGHT], options.TickRate);
+    printf("wall time: %.3f s for %ld steps\n", seconds, step);
+
+    bool settled = Settled(peers[0], options.Ticks) && Settled(peers[1], options.Ticks);
+    bool matches = false;
+    if (settled)
+    {
+        uint32_t reference = ReferenceChecksum(peers, options);
+        uint32_t left = VersusChecksum(peers[VERSUS_LEFT].Session.State);
+        uint32_t right = VersusChecksum(peers[VERSUS_RIGHT].Session.State);
+        matches = left == reference && right == reference;
+        printf("final state: left %08x right %08x reference %08x\n", left, right, reference);
+        VersusState const &state = peers[VERSUS_LEFT].Session.State;
+        printf("score: %d - %d\n", state.Score[VERSUS_LEFT], state.Score[VERSUS_RIGHT]);
+    }
+    else
+    {
+        printf("sides did not confirm every tick within 10 s, the link is too slow for the rollback window\n");
+    }
+    bool desynced = peers[0].Session.Stats.Desyncs > 0 || peers[1].Session.Stats.Desyncs > 0;
+    printf("%s\n", matches && !desynced ? "match" : "MISMATCH");
+    CloseTransport(peers[0].Transport);
+    CloseTransport(peers[1].Transport);
+    return matches && !desynced ? 0 : 1;
+}
+
+static int RunPlayer(NetOptions const &options, int side)
+{
+    static NetPeer peer;
+    if (!OpenPeer(peer, side, options, options.Port, options.PeerPort))
+    {
+        return 1;
+    }
+
+    // After the last tick keep answering for a second, the other side may still need our acknowledgements
+    double deltaTime = 1.0 / options.TickRate;
+    double start = WallClock();
+    double settledAt = -1.0;
+    long step = 0;
+    for (;; step++)
+    {
+        double now = WallClock() - start;
+        TickPeer(peer, options.Ticks, now);
+        if (settledAt < 0.0 && Settled(peer, options.Ticks))
+        {
+            settledAt = now;
+        }
+        if ((settledAt >= 0.0 && now > settledAt + 1.0) || now > options.Ticks * deltaTime + 30.0)
+        {
+            break;
+        }
+        double wait = (step + 1) * deltaTime - (WallClock() - start);
+        if (wait > 0.0)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+        }
+    }
+
+    PrintHeader(options);
+    PrintStats(peer, options.TickRate);
+    if (settledAt < 0.0)
+    {
+        printf("the other side never confirmed every tick\n");
+        CloseTransport(peer.Transport);
+        return 1;
+    }
+    // The other side prints the same checksum when both agree
+    printf("final state: %08x, score %d - %d\n", VersusChecksum(peer.Session.State),
+           peer.Session.State.Score[VERSUS_LEFT], peer.Session.State.Score[VERSUS_RIGHT]);
+    CloseTransport(peer.Transport);
+    return peer.Session.Stats.Desyncs > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    NetOptions options = {};
+    options.Ticks = 120 * 60;
+    options.TickRate = 120.0f;
+    options.Seed = 1;
+    options.InputDelay = 2;
+    options.Port = 7777;
+    options.PeerPort = 7778;
+    options.Skill = KEEPER_NORMAL;
+    int player = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--realtime") == 0)
+        {
+            options.Realtime = true;
+        }
+        else if (strcmp(argv[i], "--ticks") == 0 && hasValue)
+        {
+            options.Ticks = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && hasValue)
+        {
+            options.TickRate = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.Seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--latency") == 0 && hasValue)
+        {
+            options.Link.Latency = (float)atof(argv[++i]) / 1000.0f;
+        }
+        else if (strcmp(argv[i], "--jitter") == 0 && hasValue)
+        {
+            options.Link.Jitter = (float)atof(argv[++i]) / 1000.0f;
+        }
+        else if (strcmp(argv[i], "--loss") == 0 && hasValue)
+        {
+            options.Link.Loss = (float)atof(argv[++i]) / 100.0f;
+        }
+        else if (strcmp(argv[i], "--delay") == 0 && hasValue)
+        {
+            options.InputDelay = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--port") == 0 && hasValue)
+        {
+            options.Port = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--peer-port") == 0 && hasValue)
+        {
+            options.PeerPort = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--peer") == 0 && hasValue)
+        {
+            options.PeerHost = argv[++i];
+        }
+        else if (strcmp(argv[i], "--player") == 0 && hasValue)
+        {
+            i++;
+            player = strcmp(argv[i], "left") == 0 ? VERSUS_LEFT : strcmp(argv[i], "right") == 0 ? VERSUS_RIGHT : -2;
+        }
+        else if (strcmp(argv[i], "--ai") == 0 && hasValue)
+        {
+            options.Skill = FindKeeperSkill(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (options.Ticks <= 0 || options.TickRate <= 0.0f || options.Skill < 0 || player == -2)
+    {
+        fprintf(stderr, "--ticks and --tick-rate must be positive, --ai easy|normal|hard|perfect, "
+                        "--player left|right\n");
+        return 1;
+    }
+    return player >= 0 ? RunPlayer(options, player) : RunLoopback(options);
+}
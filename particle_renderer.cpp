@@ -0,0 +1,124 @@
+#include "particle_renderer.h"
+#include <cmath>
+#include <cstring>
+
+// Buffer slots of Mesh.vboId, matching the shader locations documented in raylib.h
+static int const VERTEX_BUFFER_POSITION = 0;
+static int const VERTEX_BUFFER_COLOR = 3;
+
+void LoadParticleRenderer(ParticleRenderer &renderer, int capacity)
+{
+    renderer = {};
+    renderer.capacity = capacity;
+
+    int vertexCount = capacity * 6;
+    Mesh &mesh = renderer.mesh;
+    mesh.vertexCount = vertexCount;
+    mesh.triangleCount = capacity * 2;
+    mesh.vertices = (float *)MemAlloc(vertexCount * 3 * sizeof(float));
+    mesh.texcoords = (float *)MemAlloc(vertexCount * 2 * sizeof(float));
+    mesh.colors = (unsigned char *)MemAlloc(vertexCount * 4 * sizeof(unsigned char));
+    UploadMesh(&mesh, true);
+
+    renderer.material = LoadMaterialDefault();
+}
+
+void UnloadParticleRenderer(ParticleRenderer &renderer)
+{
+    UnloadMesh(renderer.mesh);
+    UnloadMaterial(renderer.material);
+    renderer = {};
+}
+
+static void FlushParticles(ParticleRenderer &renderer, int particles)
+{
+    Mesh mesh = renderer.mesh;
+    mesh.vertexCount = particles * 6;
+    mesh.triangleCount = particles * 2;
+    UpdateMeshBuffer(mesh, VERTEX_BUFFER_POSITION, mesh.vertices, mesh.vertexCount * 3 * sizeof(float), 0);
+    UpdateMeshBuffer(mesh, VERTEX_BUFFER_COLOR, mesh.colors, mesh.vertexCount * 4 * sizeof(unsigned char), 0);
+
+    Matrix identity = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    DrawMesh(mesh, renderer.material, identity);
+    renderer.drawCalls++;
+}
+
+void DrawParticleBatch(ParticleRenderer &renderer, ParticleStore const &store, float behind, float rotation,
+                       Camera2D view)
+{
+    renderer.drawCalls = 0;
+    if (store.count == 0)
+    {
+        return;
+    }
+
+    // Entering 2D mode flushes the shapes already queued, so particles still land on top of them
+    BeginMode2D(view);
+
+    // Every particle spins by the same angle, so the corner rotation is shared
+    float cosAngle = cosf(rotation * DEG2RAD);
+    float sinAngle = sinf(rotation * DEG2RAD);
+
+    // Alpha blended particles first, then one more pass if any particle asked for additive blending
+    bool otherModes = false;
+    for (int pass = 0; pass < 2 && (pass == 0 || otherModes); pass++)
+    {
+        int passMode = pass == 0 ? BLEND_ALPHA : BLEND_ADDITIVE;
+        BeginBlendMode(passMode);
+        float *vertex = renderer.mesh.vertices;
+        unsigned char *color = renderer.mesh.colors;
+        int batched = 0;
+        for (int c = 0; c < store.chunkCount; c++)
+        {
+            ParticleChunk const &chunk = *store.chunks[c];
+            int chunkCount = ChunkParticleCount(store, c);
+            for (int i = 0; i < chunkCount; i++)
+            {
+                if (chunk.blend[i] != passMode)
+                {
+                    otherModes = otherModes || chunk.blend[i] != BLEND_ALPHA;
+                    continue;
+                }
+                float cx = chunk.x[i] - chunk.vx[i] * behind;
+                float cy = chunk.y[i] - chunk.vy[i] * behind;
+                float half = chunk.size[i] / 2;
+                float ax = half * cosAngle, ay = half * sinAngle; // Rotated (half, 0)
+                float bx = -half * sinAngle, by = half * cosAngle; // Rotated (0, half)
+
+                // Same corner order as DrawRectanglePro: top-left, bottom-left, bottom-right, top-right
+                float corners[4][2] = {{cx - ax - bx, cy - ay - by},
+                                       {cx - ax + bx, cy - ay + by},
+                                       {cx + ax + bx, cy + ay + by},
+                                       {cx + ax - bx, cy + ay - by}};
+                int const order[6] = {0, 1, 2, 0, 2, 3};
+                float alpha = fminf(fmaxf(chunk.alpha[i], 0.0f), 1.0f);
+                unsigned char rgba[4] = {chunk.color[i].r, chunk.color[i].g, chunk.color[i].b,
+                                         (unsigned char)(alpha * chunk.color[i].a)};
+                for (int v = 0; v < 6; v++)
+                {
+                    vertex[0] = corners[order[v]][0];
+                    vertex[1] = corners[order[v]][1];
+                    vertex[2] = 0.0f;
+                    vertex += 3;
+                    memcpy(color, rgba, 4);
+                    color += 4;
+                }
+
+                if (++batched == renderer.capacity)
+                {
+                    FlushParticles(renderer, batched);
+                    vertex = renderer.mesh.vertices;
+                    color = renderer.mesh.colors;
+                    batched = 0;
+                }
+            }
+        }
+        if (batched > 0)
+        {
+            FlushParticles(renderer, batched);
+        }
+        EndBlendMode();
+    }
+
+    EndMode2D();
+}
@@ -0,0 +1,25 @@
+#ifndef PARTICLE_RENDERER_H
+#define PARTICLE_RENDERER_H
+
+#include "particles.h"
+#include "raylib.h"
+
+// Draws every live particle from one dynamic vertex buffer.
+// Quads are rotated on the CPU and streamed as plain triangles, one draw call per
+// `capacity` particles instead of one DrawRectanglePro per particle.
+struct ParticleRenderer
+{
+    Mesh mesh;
+    Material material;
+    int capacity;  // particles per draw call
+    int drawCalls; // draw calls issued by the last DrawParticleBatch
+};
+
+void LoadParticleRenderer(ParticleRenderer &renderer, int capacity);
+void UnloadParticleRenderer(ParticleRenderer &renderer);
+// behind: how far back along its velocity each particle is drawn (render interpolation)
+// view: world-to-screen transform the particle positions are in
+void DrawParticleBatch(ParticleRenderer &renderer, ParticleStore const &store, float behind, float rotation,
+                       Camera2D view);
+
+#endif
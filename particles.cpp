@@ -0,0 +1,221 @@
+#include "particles.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Makes room for one more particle: reuse a free slab, or allocate one while under the bound
+static bool GrowParticleStore(ParticleStore &store)
+{
+    if (store.count < store.chunkCount * PARTICLE_CHUNK)
+    {
+        return true;
+    }
+    if (store.chunkCount < store.allocatedChunks)
+    {
+        store.chunkCount++;
+        return true;
+    }
+    if (store.allocatedChunks == MAX_PARTICLE_CHUNKS)
+    {
+        return false;
+    }
+
+    void *memory = malloc(sizeof(ParticleChunk) + 32);
+    if (!memory)
+    {
+        return false;
+    }
+    uintptr_t aligned = ((uintptr_t)memory + 31) & ~(uintptr_t)31;
+    store.chunkMemory[store.allocatedChunks] = memory;
+    store.chunks[store.allocatedChunks] = (ParticleChunk *)aligned;
+    store.allocatedChunks++;
+    store.chunkCount++;
+    store.chunkAllocs++;
+    return true;
+}
+
+int ReserveParticles(ParticleStore &store, int wanted, int &first)
+{
+    first = store.count;
+    int granted = 0;
+    while (granted < wanted && GrowParticleStore(store))
+    {
+        // Take the rest of the current slab in one go
+        int room = store.chunkCount * PARTICLE_CHUNK - store.count;
+        int take = wanted - granted < room ? wanted - granted : room;
+        store.count += take;
+        granted += take;
+    }
+    store.dropped += wanted - granted;
+    if (store.count > store.highWater)
+    {
+        store.highWater = store.count;
+    }
+    return granted;
+}
+
+void SetFadeCurve(float &fadeA, float &fadeB, int curve)
+{
+    fadeA = curve == FADE_EASE_IN ? 0.0f : (curve == FADE_EASE_OUT ? 2.0f : 1.0f);
+    fadeB = curve == FADE_EASE_IN ? 1.0f : (curve == FADE_EASE_OUT ? -1.0f : 0.0f);
+}
+
+bool EmitParticle(ParticleStore &store, Vector2 position, Vector2 velocity, Color color, float size, float life,
+                  float fadeTime)
+{
+    int index;
+    if (ReserveParticles(store, 1, index) == 0)
+    {
+        return false;
+    }
+
+    ParticleChunk &chunk = *store.chunks[index / PARTICLE_CHUNK];
+    int i = index % PARTICLE_CHUNK;
+    chunk.x[i] = position.x;
+    chunk.y[i] = position.y;
+    chunk.vx[i] = velocity.x;
+    chunk.vy[i] = velocity.y;
+    chunk.life[i] = life;
+    chunk.invFade[i] = 1.0f / fadeTime;
+    SetFadeCurve(chunk.fadeA[i], chunk.fadeB[i], FADE_LINEAR);
+    chunk.alpha[i] = 1.0f;
+    chunk.size[i] = size;
+    chunk.color[i] = color;
+    chunk.blend[i] = BLEND_ALPHA;
+    return true;
+}
+
+static void UpdateParticleChunk(ParticleChunk &chunk, int count, float deltaTime)
+{
+    float move = deltaTime * 120;
+    int i = 0;
+
+    // Chunks are a multiple of the vector width, so the last partial vector may run past count
+#if defined(__AVX__)
+    __m256 moveV = _mm256_set1_ps(move);
+    __m256 deltaV = _mm256_set1_ps(deltaTime);
+    for (; i < count; i += 8)
+    {
+        __m256 life = _mm256_sub_ps(_mm256_load_ps(chunk.life + i), deltaV);
+        _mm256_store_ps(chunk.x + i, _mm256_add_ps(_mm256_load_ps(chunk.x + i),
+                                                   _mm256_mul_ps(_mm256_load_ps(chunk.vx + i), moveV)));
+        _mm256_store_ps(chunk.y + i, _mm256_add_ps(_mm256_load_ps(chunk.y + i),
+                                                   _mm256_mul_ps(_mm256_load_ps(chunk.vy + i), moveV)));
+        _mm256_store_ps(chunk.life + i, life);
+        __m256 t = _mm256_mul_ps(life, _mm256_load_ps(chunk.invFade + i));
+        __m256 curve =
+            _mm256_add_ps(_mm256_load_ps(chunk.fadeA + i), _mm256_mul_ps(_mm256_load_ps(chunk.fadeB + i), t));
+        _mm256_store_ps(chunk.alpha + i, _mm256_mul_ps(t, curve));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 moveV = _mm_set1_ps(move);
+    __m128 deltaV = _mm_set1_ps(deltaTime);
+    for (; i < count; i += 4)
+    {
+        __m128 life = _mm_sub_ps(_mm_load_ps(chunk.life + i), deltaV);
+        _mm_store_ps(chunk.x + i, _mm_add_ps(_mm_load_ps(chunk.x + i), _mm_mul_ps(_mm_load_ps(chunk.vx + i), moveV)));
+        _mm_store_ps(chunk.y + i, _mm_add_ps(_mm_load_ps(chunk.y + i), _mm_mul_ps(_mm_load_ps(chunk.vy + i), moveV)));
+        _mm_store_ps(chunk.life + i, life);
+        __m128 t = _mm_mul_ps(life, _mm_load_ps(chunk.invFade + i));
+        __m128 curve = _mm_add_ps(_mm_load_ps(chunk.fadeA + i), _mm_mul_ps(_mm_load_ps(chunk.fadeB + i), t));
+        _mm_store_ps(chunk.alpha + i, _mm_mul_ps(t, curve));
+    }
+#else
+    for (; i < count; i++)
+    {
+        chunk.x[i] += chunk.vx[i] * move;
+        chunk.y[i] += chunk.vy[i] * move;
+        chunk.life[i] -= deltaTime;
+        float t = chunk.life[i] * chunk.invFade[i];
+        chunk.alpha[i] = t * (chunk.fadeA[i] + chunk.fadeB[i] * t);
+    }
+#endif
+}
+
+void UpdateParticleStore(ParticleStore &store, float deltaTime)
+{
+    for (int chunk = 0; chunk < store.chunkCount; chunk++)
+    {
+        UpdateParticleChunk(*store.chunks[chunk], ChunkParticleCount(store, chunk), deltaTime);
+    }
+}
+
+void CompactParticleStore(ParticleStore &store)
+{
+    for (int index = store.count - 1; index >= 0; index--)
+    {
+        ParticleChunk &chunk = *store.chunks[index / PARTICLE_CHUNK];
+        int i = index % PARTICLE_CHUNK;
+        if (chunk.life[i] <= 0)
+        {
+            int lastIndex = --store.count;
+            ParticleChunk &lastChunk = *store.chunks[lastIndex / PARTICLE_CHUNK];
+            int last = lastIndex % PARTICLE_CHUNK;
+            chunk.x[i] = lastChunk.x[last];
+            chunk.y[i] = lastChunk.y[last];
+            chunk.vx[i] = lastChunk.vx[last];
+            chunk.vy[i] = lastChunk.vy[last];
+            chunk.life[i] = lastChunk.life[last];
+            chunk.invFade[i] = lastChunk.invFade[last];
+            chunk.fadeA[i] = lastChunk.fadeA[last];
+            chunk.fadeB[i] = lastChunk.fadeB[last];
+            chunk.alpha[i] = lastChunk.alpha[last];
+            chunk.size[i] = lastChunk.size[last];
+            chunk.color[i] = lastChunk.color[last];
+            chunk.blend[i] = lastChunk.blend[last];
+        }
+    }
+
+    // Emptied slabs go back to the free list
+    store.chunkCount = (store.count + PARTICLE_CHUNK - 1) / PARTICLE_CHUNK;
+}
+
+void ClearParticleStore(ParticleStore &store)
+{
+    store.count = 0;
+    store.chunkCount = 0;
+}
+
+Rectangle ParticleBounds(ParticleStore const &store, float behind)
+{
+    if (store.count == 0)
+    {
+        return {0, 0, 0, 0};
+    }
+    float left = 1e30f, top = 1e30f, right = -1e30f, bottom = -1e30f;
+    for (int c = 0; c < store.chunkCount; c++)
+    {
+        ParticleChunk const &chunk = *store.chunks[c];
+        int count = ChunkParticleCount(store, c);
+        for (int i = 0; i < count; i++)
+        {
+            // Half the diagonal covers the square at any rotation
+            float reach = chunk.size[i] * 0.71f;
+            float x = chunk.x[i] - chunk.vx[i] * behind;
+            float y = chunk.y[i] - chunk.vy[i] * behind;
+            left = fminf(left, x - reach);
+            top = fminf(top, y - reach);
+            right = fmaxf(right, x + reach);
+            bottom = fmaxf(bottom, y + reach);
+        }
+    }
+    return {left, top, right - left, bottom - top};
+}
+
+void ReleaseParticleStore(ParticleStore &store)
+{
+    for (int chunk = 0; chunk < store.allocatedChunks; chunk++)
+    {
+        free(store.chunkMemory[chunk]);
+        store.chunkMemory[chunk] = nullptr;
+        store.chunks[chunk] = nullptr;
+    }
+    store.allocatedChunks = 0;
+    ClearParticleStore(store);
+}
@@ -0,0 +1,76 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+
+int const PARTICLE_CHUNK = 4096;     // Particles per slab, a multiple of the SIMD width
+int const MAX_PARTICLE_CHUNKS = 32;  // Memory bound of one store
+int const MAX_PARTICLES = PARTICLE_CHUNK * MAX_PARTICLE_CHUNKS;
+
+// One slab of particles as structure-of-arrays, every lane padded for 8-wide SIMD
+struct ParticleChunk
+{
+    alignas(32) float x[PARTICLE_CHUNK];
+    alignas(32) float y[PARTICLE_CHUNK];
+    alignas(32) float vx[PARTICLE_CHUNK];
+    alignas(32) float vy[PARTICLE_CHUNK];
+    alignas(32) float life[PARTICLE_CHUNK];
+    alignas(32) float invFade[PARTICLE_CHUNK]; // t = life * invFade runs from 1 down to 0 over the fade time
+    alignas(32) float fadeA[PARTICLE_CHUNK];   // alpha = t * (fadeA + fadeB * t), see FADE_*
+    alignas(32) float fadeB[PARTICLE_CHUNK];
+    alignas(32) float alpha[PARTICLE_CHUNK];
+    alignas(32) float size[PARTICLE_CHUNK];
+    Color color[PARTICLE_CHUNK];
+    unsigned char blend[PARTICLE_CHUNK]; // raylib BlendMode
+};
+
+// Fade curves, as the (fadeA, fadeB) pair of a particle
+enum
+{
+    FADE_LINEAR,   // alpha = t
+    FADE_EASE_IN,  // alpha = t^2, fades fast at first
+    FADE_EASE_OUT, // alpha = 2t - t^2, stays bright longer
+    FADE_CURVE_COUNT
+};
+
+// Pooled particle storage that grows one slab at a time.
+// Live particles are always packed in [0, count): particle i is lane i % PARTICLE_CHUNK of chunk
+// i / PARTICLE_CHUNK. Slabs emptied by compaction or a restart stay allocated in [chunkCount,
+// allocatedChunks) and are handed out again before anything new is allocated, so after warm-up
+// emitting never touches the heap. Zero-initialize before first use.
+struct ParticleStore
+{
+    int count;
+    int chunkCount;                              // Slabs holding live particles
+    int allocatedChunks;                         // Slabs owned, the rest of them form the free list
+    ParticleChunk *chunks[MAX_PARTICLE_CHUNKS];  // 32-byte aligned
+    void *chunkMemory[MAX_PARTICLE_CHUNKS];      // What was allocated, for freeing
+
+    // Stats
+    int highWater;    // Most particles alive at once
+    int dropped;      // Emits refused because the store was at MAX_PARTICLES
+    int chunkAllocs;  // Heap allocations so far, stops growing after warm-up
+};
+
+// Linear fade, alpha blending
+bool EmitParticle(ParticleStore &store, Vector2 position, Vector2 velocity, Color color, float size, float life,
+                  float fadeTime);
+// Appends up to `wanted` particles at [first, first + granted) and returns granted, for callers that fill
+// the lanes themselves. Whatever doesn't fit under MAX_PARTICLES is counted as dropped.
+int ReserveParticles(ParticleStore &store, int wanted, int &first);
+void SetFadeCurve(float &fadeA, float &fadeB, int curve);
+void UpdateParticleStore(ParticleStore &store, float deltaTime); // Integrate every lane, no removal
+void CompactParticleStore(ParticleStore &store);                  // Drop particles whose life ran out
+void ClearParticleStore(ParticleStore &store);                    // Drop everything, keep the slabs
+void ReleaseParticleStore(ParticleStore &store);                  // Free the slabs
+// Area the live particles cover when drawn `behind` along their velocity, empty if there are none
+Rectangle ParticleBounds(ParticleStore const &store, float behind);
+
+// Live particles in one chunk
+inline int ChunkParticleCount(ParticleStore const &store, int chunk)
+{
+    int left = store.count - chunk * PARTICLE_CHUNK;
+    return left < PARTICLE_CHUNK ? left : PARTICLE_CHUNK;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+static char const *phaseNames[PHASE_COUNT] = {"update", "collisions", "field",   "goal", "sprites",
+                                              "particles", "text",     "present", "frame"};
+
+double ProfilerNow(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+char const *PhaseName(int phase)
+{
+    return (phase >= 0 && phase < PHASE_COUNT) ? phaseNames[phase] : "?";
+}
+
+void ResetProfiler(FrameProfiler &profiler)
+{
+    profiler = {};
+}
+
+void BeginProfileFrame(FrameProfiler &profiler)
+{
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        profiler.Current[i] = 0.0;
+    }
+    profiler.FrameStart = ProfilerNow();
+}
+
+void EndProfileFrame(FrameProfiler &profiler)
+{
+    profiler.Current[PHASE_FRAME] = ProfilerNow() - profiler.FrameStart;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        profiler.History[profiler.Next][i] = (float)(profiler.Current[i] * 1000.0);
+    }
+    profiler.Next = (profiler.Next + 1) % PROFILE_FRAMES;
+    if (profiler.Frames < PROFILE_FRAMES)
+    {
+        profiler.Frames++;
+    }
+}
+
+PhaseStats GetPhaseStats(FrameProfiler const &profiler, int phase)
+{
+    PhaseStats stats = {};
+    if (profiler.Frames == 0)
+    {
+        return stats;
+    }
+
+    float samples[PROFILE_FRAMES];
+    float sum = 0.0f;
+    for (int i = 0; i < profiler.Frames; i++)
+    {
+        samples[i] = profiler.History[i][phase];
+        sum += samples[i];
+    }
+    stats.Min = *std::min_element(samples, samples + profiler.Frames);
+    stats.Average = sum / profiler.Frames;
+
+    // Nearest-rank percentile, so with few frames it is simply the worst one
+    int rank = (int)(0.99f * profiler.Frames);
+    if (rank >= profiler.Frames)
+    {
+        rank = profiler.Frames - 1;
+    }
+    std::nth_element(samples, samples + rank, samples + profiler.Frames);
+    stats.P99 = samples[rank];
+    return stats;
+}
+
+bool WriteProfileCsv(FrameProfiler const &profiler, char const *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "phase,min_ms,avg_ms,p99_ms,frames\n");
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseStats stats = GetPhaseStats(profiler, i);
+        fprintf(file, "%s,%.4f,%.4f,%.4f,%d\n", PhaseName(i), stats.Min, stats.Average, stats.P99, profiler.Frames);
+    }
+    return fclose(file) == 0;
+}
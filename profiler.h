@@ -0,0 +1,64 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// CPU frame profiler: per-phase wall time for the last PROFILE_FRAMES frames.
+// GPU work is asynchronous, so draw phases measure command submission, and present
+// also includes the frame rate wait, SetTargetFPS or low-latency pacing.
+enum ProfilePhase
+{
+    PHASE_UPDATE,
+    PHASE_COLLISIONS,
+    PHASE_FIELD,
+    PHASE_GOAL,
+    PHASE_SPRITES, // ball and keeper
+    PHASE_PARTICLES,
+    PHASE_TEXT,
+    PHASE_PRESENT,
+    PHASE_FRAME, // whole frame, set by EndProfileFrame
+    PHASE_COUNT
+};
+
+int const PROFILE_FRAMES = 240;
+
+struct FrameProfiler
+{
+    double FrameStart;
+    double Current[PHASE_COUNT];                // Seconds spent so far this frame
+    float History[PROFILE_FRAMES][PHASE_COUNT]; // Milliseconds, ring buffer
+    int Next;                                   // Slot the next finished frame goes to
+    int Frames;                                 // Filled slots, up to PROFILE_FRAMES
+};
+
+struct PhaseStats
+{
+    float Min;
+    float Average;
+    float P99;
+};
+
+double ProfilerNow(void); // Seconds from a monotonic clock
+char const *PhaseName(int phase);
+
+void ResetProfiler(FrameProfiler &profiler);
+void BeginProfileFrame(FrameProfiler &profiler);
+void EndProfileFrame(FrameProfiler &profiler);
+PhaseStats GetPhaseStats(FrameProfiler const &profiler, int phase); // Over the buffered frames, in milliseconds
+bool WriteProfileCsv(FrameProfiler const &profiler, char const *path);
+
+// Adds the time until the end of the enclosing block to one phase of the current frame
+struct ProfileScope
+{
+    FrameProfiler &Profiler;
+    int Phase;
+    double Start;
+
+    ProfileScope(FrameProfiler &profiler, int phase) : Profiler(profiler), Phase(phase), Start(ProfilerNow())
+    {
+    }
+    ~ProfileScope()
+    {
+        Profiler.Current[Phase] += ProfilerNow() - Start;
+    }
+};
+
+#endif
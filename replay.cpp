@@ -0,0 +1,359 @@
+#include "replay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static char const REPLAY_MAGIC[4] = {'F', 'A', 'R', 'P'};
+static uint16_t const REPLAY_VERSION = 3;
+static uint16_t const REPLAY_HAS_HASHES = 1;
+static uint16_t const REPLAY_HAS_BRICKS = 2;
+static int const TICK_HASH_SIZE = 4 + STATE_FIELD_COUNT;
+static int const VERSION_2_FIELDS = 9; // Before the bricks field
+static int const BRICK_HEADER_SIZE = 24;
+
+enum
+{
+    INPUT_UP = 1,
+    INPUT_DOWN = 2,
+    INPUT_TOGGLE_PAUSE = 4,
+    INPUT_RESTART = 8
+};
+
+unsigned char PackInput(SimInput input)
+{
+    return (input.Up ? INPUT_UP : 0) | (input.Down ? INPUT_DOWN : 0) | (input.TogglePause ? INPUT_TOGGLE_PAUSE : 0) |
+           (input.Restart ? INPUT_RESTART : 0);
+}
+
+SimInput UnpackInput(unsigned char bits)
+{
+    SimInput input = {};
+    input.Up = bits & INPUT_UP;
+    input.Down = bits & INPUT_DOWN;
+    input.TogglePause = bits & INPUT_TOGGLE_PAUSE;
+    input.Restart = bits & INPUT_RESTART;
+    return input;
+}
+
+uint32_t WorldChecksum(World const &world)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    HashBytes(hash, &world.score, sizeof(world.score));
+    HashBytes(hash, &world.goals, sizeof(world.goals));
+    HashBytes(hash, &world.ball.Position, sizeof(world.ball.Position));
+    HashBytes(hash, &world.ball.Direction, sizeof(world.ball.Direction));
+    HashBytes(hash, &world.keeper.Position, sizeof(world.keeper.Position));
+    int state = world.ball.State;
+    HashBytes(hash, &state, sizeof(state));
+    return hash;
+}
+
+void BeginReplay(Replay &replay, uint64_t seed, float tickRate)
+{
+    replay.Seed = seed;
+    replay.TickRate = tickRate;
+    replay.TickCount = 0;
+    replay.Inputs.clear();
+    replay.Hashes.clear();
+    ClearBrickField(replay.Bricks);
+    replay.FinalScore = 0;
+    replay.FinalGoals = 0;
+    replay.FinalChecksum = 0;
+}
+
+static TickHash MakeTickHash(World const &world)
+{
+    StateHash state;
+    HashWorldState(world, state);
+    TickHash hash;
+    hash.State = CombineStateHash(state);
+    for (int field = 0; field < STATE_FIELD_COUNT; field++)
+    {
+        hash.Fields[field] = (unsigned char)state.Fields[field];
+    }
+    return hash;
+}
+
+void RecordReplayTick(Replay &replay, World const &world, SimInput input)
+{
+    replay.Hashes.push_back(MakeTickHash(world));
+    unsigned char bits = PackInput(input);
+    if (replay.TickCount % 2 == 0)
+    {
+        replay.Inputs.push_back(bits);
+    }
+    else
+    {
+        replay.Inputs.back() |= bits << 4;
+    }
+    replay.TickCount++;
+}
+
+void TruncateReplay(Replay &replay, int tickCount)
+{
+    if (tickCount < 0 || tickCount >= replay.TickCount)
+    {
+        return;
+    }
+    replay.TickCount = tickCount;
+    replay.Inputs.resize((tickCount + 1) / 2);
+    if (replay.Hashes.size() > (size_t)tickCount)
+    {
+        replay.Hashes.resize(tickCount);
+    }
+    if (tickCount % 2 == 1)
+    {
+        // The last byte's high nibble belonged to the dropped tick
+        replay.Inputs.back() &= 0x0f;
+    }
+}
+
+void FinishReplay(Replay &replay, World const &world)
+{
+    replay.FinalScore = world.score;
+    replay.FinalGoals = world.goals;
+    replay.FinalChecksum = WorldChecksum(world);
+    // The level doesn't change during a game, only which of its bricks stand
+    replay.Bricks = world.bricks;
+}
+
+SimInput ReplayInput(Replay const &replay, int tick)
+{
+    unsigned char byte = replay.Inputs[tick / 2];
+    return UnpackInput(tick % 2 == 0 ? byte & 0x0F : byte >> 4);
+}
+
+static void PutU32(unsigned char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint32_t GetU32(unsigned char const *in)
+{
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static std::vector<unsigned char> PackBrickLevel(BrickField const &field)
+{
+    std::vector<unsigned char> out(BRICK_HEADER_SIZE + field.Rows * BRICK_ROW_WORDS * 8);
+    float geometry[4] = {field.Area.x, field.Area.y, field.Area.width, field.Area.height};
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t bits;
+        memcpy(&bits, &geometry[i], sizeof(bits));
+        PutU32(&out[4 * i], bits);
+    }
+    PutU32(&out[16], (uint32_t)field.Columns);
+    PutU32(&out[20], (uint32_t)field.Rows);
+    unsigned char *cells = &out[BRICK_HEADER_SIZE];
+    for (int row = 0; row < field.Rows; row++)
+    {
+        for (int word = 0; word < BRICK_ROW_WORDS; word++)
+        {
+            uint64_t bits = field.Level.Rows[row][word];
+            PutU32(cells, (uint32_t)bits);
+            PutU32(cells + 4, (uint32_t)(bits >> 32));
+            cells += 8;
+        }
+    }
+    return out;
+}
+
+static bool ReadBrickLevel(BrickField &field, FILE *file)
+{
+    unsigned char header[BRICK_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, file) != 1)
+    {
+        return false;
+    }
+    ClearBrickField(field);
+    float geometry[4];
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t bits = GetU32(header + 4 * i);
+        memcpy(&geometry[i], &bits, sizeof(bits));
+    }
+    field.Area = {geometry[0], geometry[1], geometry[2], geometry[3]};
+    field.Columns = (int)GetU32(header + 16);
+    field.Rows = (int)GetU32(header + 20);
+    if (field.Columns <= 0 || field.Columns > BRICK_MAX_COLUMNS || field.Rows <= 0 || field.Rows > BRICK_MAX_ROWS)
+    {
+        return false;
+    }
+    field.CellWidth = field.Area.width / field.Columns;
+    field.CellHeight = field.Area.height / field.Rows;
+
+    std::vector<unsigned char> cells(field.Rows * BRICK_ROW_WORDS * 8);
+    if (fread(cells.data(), cells.size(), 1, file) != 1)
+    {
+        return false;
+    }
+    for (int row = 0; row < field.Rows; row++)
+    {
+        for (int word = 0; word < BRICK_ROW_WORDS; word++)
+        {
+            unsigned char const *in = &cells[(row * BRICK_ROW_WORDS + word) * 8];
+            uint64_t bits = GetU32(in) | ((uint64_t)GetU32(in + 4) << 32);
+            field.Level.Rows[row][word] = bits;
+            for (; bits; bits &= bits - 1)
+            {
+                field.Level.Remaining++;
+            }
+        }
+    }
+    RestoreBrickLevel(field);
+    return true;
+}
+
+bool SaveReplay(Replay const &replay, char const *path)
+{
+    bool hashed = replay.TickCount > 0 && replay.Hashes.size() == (size_t)replay.TickCount;
+    bool bricks = replay.Bricks.Columns > 0;
+    unsigned char header[24];
+    uint32_t tickRateBits;
+    memcpy(&tickRateBits, &replay.TickRate, sizeof(tickRateBits));
+    memcpy(header, REPLAY_MAGIC, 4);
+    header[4] = REPLAY_VERSION & 0xFF;
+    header[5] = REPLAY_VERSION >> 8;
+    header[6] = (hashed ? REPLAY_HAS_HASHES : 0) | (bricks ? REPLAY_HAS_BRICKS : 0);
+    header[7] = hashed ? STATE_FIELD_COUNT : 0;
+    PutU32(header + 8, (uint32_t)replay.Seed);
+    PutU32(header + 12, (uint32_t)(replay.Seed >> 32));
+    PutU32(header + 16, tickRateBits);
+    PutU32(header + 20, (uint32_t)replay.TickCount);
+
+    std::vector<unsigned char> hashes;
+    if (hashed)
+    {
+        hashes.resize((size_t)replay.TickCount * TICK_HASH_SIZE);
+        for (int tick = 0; tick < replay.TickCount; tick++)
+        {
+            unsigned char *out = &hashes[(size_t)tick * TICK_HASH_SIZE];
+            PutU32(out, replay.Hashes[tick].State);
+            memcpy(out + 4, replay.Hashes[tick].Fields, STATE_FIELD_COUNT);
+        }
+    }
+
+    std::vector<unsigned char> level;
+    if (bricks)
+    {
+        level = PackBrickLevel(replay.Bricks);
+    }
+
+    unsigned char footer[12];
+    PutU32(footer, (uint32_t)replay.FinalScore);
+    PutU32(footer + 4, (uint32_t)replay.FinalGoals);
+    PutU32(footer + 8, replay.FinalChecksum);
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+              (replay.Inputs.empty() || fwrite(replay.Inputs.data(), replay.Inputs.size(), 1, file) == 1) &&
+              (hashes.empty() || fwrite(hashes.data(), hashes.size(), 1, file) == 1) &&
+              (level.empty() || fwrite(level.data(), level.size(), 1, file) == 1) &&
+              fwrite(footer, sizeof(footer), 1, file) == 1;
+    return fclose(file) == 0 && ok;
+}
+
+bool LoadReplay(Replay &replay, char const *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    unsigned char header[24];
+    bool ok = fread(header, sizeof(header), 1, file) == 1 && memcmp(header, REPLAY_MAGIC, 4) == 0;
+    int version = ok ? header[4] | (header[5] << 8) : 0;
+    ok = ok && version >= 1 && version <= REPLAY_VERSION;
+    if (ok)
+    {
+        bool hashed = version >= 2 && (header[6] & REPLAY_HAS_HASHES);
+        bool bricks = version >= 3 && (header[6] & REPLAY_HAS_BRICKS);
+        // Hashes of another set of fields can't be compared with this build's, they are skipped
+        int fields = version == 2 ? VERSION_2_FIELDS : header[7];
+        int hashSize = 4 + fields;
+        uint32_t tickRateBits = GetU32(header + 16);
+        replay.Seed = GetU32(header + 8) | ((uint64_t)GetU32(header + 12) << 32);
+        memcpy(&replay.TickRate, &tickRateBits, sizeof(replay.TickRate));
+        replay.TickCount = (int)GetU32(header + 20);
+        replay.Inputs.resize((replay.TickCount + 1) / 2);
+        std::vector<unsigned char> hashes(hashed ? (size_t)replay.TickCount * hashSize : 0);
+        ClearBrickField(replay.Bricks);
+
+        unsigned char footer[12];
+        ok = (replay.Inputs.empty() || fread(replay.Inputs.data(), replay.Inputs.size(), 1, file) == 1) &&
+             (hashes.empty() || fread(hashes.data(), hashes.size(), 1, file) == 1) &&
+             (!bricks || ReadBrickLevel(replay.Bricks, file)) && fread(footer, sizeof(footer), 1, file) == 1;
+        if (ok)
+        {
+            replay.Hashes.resize(fields == STATE_FIELD_COUNT ? hashes.size() / TICK_HASH_SIZE : 0);
+            for (size_t tick = 0; tick < replay.Hashes.size(); tick++)
+            {
+                unsigned char const *in = &hashes[tick * TICK_HASH_SIZE];
+                replay.Hashes[tick].State = GetU32(in);
+                memcpy(replay.Hashes[tick].Fields, in + 4, STATE_FIELD_COUNT);
+            }
+            replay.FinalScore = (int)GetU32(footer);
+            replay.FinalGoals = (int)GetU32(footer + 4);
+            replay.FinalChecksum = GetU32(footer + 8);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+ReplayResult PlayReplay(Replay const &replay)
+{
+    World world;
+    InitWorld(world, replay.Seed);
+    if (replay.Bricks.Columns > 0)
+    {
+        world.bricks = replay.Bricks;
+        RestoreBrickLevel(world.bricks);
+    }
+    float deltaTime = 1.0f / replay.TickRate;
+
+    ReplayResult result;
+    result.DivergedTick = -1;
+    result.DivergedFields = 0;
+    bool checkHashes = replay.Hashes.size() == (size_t)replay.TickCount;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < replay.TickCount; tick++)
+    {
+        // Once off track every later tick differs too, only the first one says anything
+        if (checkHashes && result.DivergedTick < 0)
+        {
+            TickHash hash = MakeTickHash(world);
+            TickHash const &recorded = replay.Hashes[tick];
+            if (hash.State != recorded.State)
+            {
+                result.DivergedTick = tick;
+                for (int field = 0; field < STATE_FIELD_COUNT; field++)
+                {
+                    if (hash.Fields[field] != recorded.Fields[field])
+                    {
+                        result.DivergedFields |= 1u << field;
+                    }
+                }
+            }
+        }
+        Step(world, ReplayInput(replay, tick), deltaTime);
+    }
+
+    result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.Score = world.score;
+    result.Goals = world.goals;
+    result.Checksum = WorldChecksum(world);
+    result.Matches = result.Score == replay.FinalScore && result.Goals == replay.FinalGoals &&
+                     result.Checksum == replay.FinalChecksum && result.DivergedTick < 0;
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "simulation.h"
+#include "state_hash.h"
+#include <stdint.h>
+#include <vector>
+
+// Binary replay: seed + tick rate + one 4-bit input nibble per tick + state hashes + brick level + final
+// state check. A replay only reproduces when every tick was a fixed step of 1 / TickRate.
+//
+// File layout, little endian:
+//   "FARP"  u16 version  u8 flags  u8 fieldCount  u64 seed  f32 tickRate  u32 tickCount
+//   ceil(tickCount / 2) bytes of inputs, even ticks in the low nibble
+//   if flags & 1: tickCount entries of u32 state hash then fieldCount field bytes
+//   if flags & 2: f32 x y width height  u32 columns rows, then rows * BRICK_ROW_WORDS u64 of level bricks
+//   i32 finalScore  i32 finalGoals  u32 finalChecksum
+// Version 1 files have no flags and no hashes, version 2 ones always have 9 fields and no bricks.
+// Hashes with another fieldCount than this build's STATE_FIELD_COUNT are skipped.
+
+// State at the start of a tick, before its input is applied
+struct TickHash
+{
+    uint32_t State;                          // CombineStateHash
+    unsigned char Fields[STATE_FIELD_COUNT]; // Low byte of each field hash, enough to name what drifted
+};
+
+struct Replay
+{
+    uint64_t Seed;
+    float TickRate;
+    int TickCount;
+    std::vector<unsigned char> Inputs; // Packed, two ticks per byte
+    std::vector<TickHash> Hashes;      // One per tick, empty when the file has none
+    BrickField Bricks;                 // Level the game was played on, no columns when there was none
+    int FinalScore;
+    int FinalGoals;
+    uint32_t FinalChecksum;
+};
+
+struct ReplayResult
+{
+    bool Matches;
+    int Score;
+    int Goals;
+    uint32_t Checksum;
+    int DivergedTick;        // First tick whose starting state hashed differently, -1 when none did
+    uint32_t DivergedFields; // Bit per StateField that differed there, 0 when the field bytes happen to agree
+    double Seconds;          // Wall time spent re-simulating
+};
+
+unsigned char PackInput(SimInput input);
+SimInput UnpackInput(unsigned char bits);
+uint32_t WorldChecksum(World const &world);
+
+void BeginReplay(Replay &replay, uint64_t seed, float tickRate);
+void RecordReplayTick(Replay &replay, World const &world, SimInput input); // Call before stepping world
+void TruncateReplay(Replay &replay, int tickCount); // Forget the inputs from tickCount on, e.g. after a rewind
+void FinishReplay(Replay &replay, World const &world);
+SimInput ReplayInput(Replay const &replay, int tick);
+
+bool SaveReplay(Replay const &replay, char const *path);
+bool LoadReplay(Replay &replay, char const *path);
+
+// Re-simulate headlessly as fast as possible and compare against the recorded hashes and result
+ReplayResult PlayReplay(Replay const &replay);
+
+#endif
@@ -0,0 +1,59 @@
+#include "rng.h"
+
+static uint64_t SplitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t RotateLeft(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+void SeedRng(Rng &rng, uint64_t seed)
+{
+    uint64_t a = SplitMix64(seed);
+    uint64_t b = SplitMix64(seed);
+    rng.s[0] = (uint32_t)a;
+    rng.s[1] = (uint32_t)(a >> 32);
+    rng.s[2] = (uint32_t)b;
+    rng.s[3] = (uint32_t)(b >> 32);
+}
+
+uint32_t NextRandom(Rng &rng)
+{
+    uint32_t *s = rng.s;
+    uint32_t result = RotateLeft(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 11);
+    return result;
+}
+
+int RandomRange(Rng &rng, int min, int max)
+{
+    if (min > max)
+    {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    uint32_t range = (uint32_t)(max - min) + 1;
+    // Multiply-shift instead of modulo: no division and no low-bit bias
+    return min + (int)(((uint64_t)NextRandom(rng) * range) >> 32);
+}
+
+float RandomFloat(Rng &rng, float min, float max)
+{
+    // Top 24 bits, exactly representable as a float in [0, 1)
+    float unit = (NextRandom(rng) >> 8) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
@@ -0,0 +1,17 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xoshiro128** generator. Plain data, so it copies with the world state it belongs to.
+struct Rng
+{
+    uint32_t s[4];
+};
+
+void SeedRng(Rng &rng, uint64_t seed); // Any seed, including 0, gives a valid state
+uint32_t NextRandom(Rng &rng);
+int RandomRange(Rng &rng, int min, int max); // Between min and max, both included (like GetRandomValue)
+float RandomFloat(Rng &rng, float min, float max); // Uniform in [min, max)
+
+#endif
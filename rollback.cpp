@@ -0,0 +1,213 @@
+#include "rollback.h"
+#include "replay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static uint32_t const MESSAGE_MAGIC = 0x4e494146; // "FAIN" in little endian
+
+// Remote input for a tick it hasn't sent yet: keep moving the way it was, presses don't repeat
+static unsigned char PredictRemote(RollbackSession const &session)
+{
+    if (session.RemoteTicks == 0)
+    {
+        return 0;
+    }
+    SimInput last = UnpackInput(session.Inputs[1 - session.LocalSide][(session.RemoteTicks - 1) % ROLLBACK_RING]);
+    SimInput guess = {};
+    guess.Up = last.Up;
+    guess.Down = last.Down;
+    return PackInput(guess);
+}
+
+// Simulates tick t from State, which has to be the state at its start
+static void SimulateTick(RollbackSession &session, int t)
+{
+    int slot = t % ROLLBACK_RING;
+    int remote = 1 - session.LocalSide;
+    session.Saved[slot] = session.State;
+    if (t >= session.RemoteTicks)
+    {
+        session.Inputs[remote][slot] = PredictRemote(session);
+    }
+    SimInput inputs[2];
+    inputs[session.LocalSide] = UnpackInput(session.Inputs[session.LocalSide][slot]);
+    inputs[remote] = UnpackInput(session.Inputs[remote][slot]);
+    StepVersus(session.State, inputs, session.DeltaTime);
+}
+
+// Checksums the states that now only depend on known inputs, once mispredictions are resolved
+static void UpdateConfirmed(RollbackSession &session)
+{
+    int confirmed = std::min(session.RemoteTicks, session.Tick);
+    while (session.Confirmed < confirmed)
+    {
+        session.Confirmed++;
+        int t = session.Confirmed;
+        VersusState const &state = t == session.Tick ? session.State : session.Saved[t % ROLLBACK_RING];
+        session.Checksums[t % ROLLBACK_RING] = VersusChecksum(state);
+    }
+}
+
+void InitRollback(RollbackSession &session, int localSide, int inputDelay, float deltaTime, uint64_t seed)
+{
+    session = {};
+    session.LocalSide = localSide;
+    session.InputDelay = std::max(0, std::min(inputDelay, ROLLBACK_MAX_DELAY));
+    session.DeltaTime = deltaTime;
+    InitVersus(session.State, seed);
+    // The first InputDelay ticks play no local input
+    session.LocalTicks = session.InputDelay;
+    session.FirstMispredicted = -1;
+    session.Stats.FirstDesyncTick = -1;
+    session.Checksums[0] = VersusChecksum(session.State);
+}
+
+bool AdvanceRollback(RollbackSession &session, SimInput local)
+{
+    if (session.Tick - session.RemoteTicks >= ROLLBACK_MAX_AHEAD)
+    {
+        session.Stats.Stalls++;
+        return false;
+    }
+
+    session.Inputs[session.LocalSide][session.LocalTicks % ROLLBACK_RING] = PackInput(local);
+    session.LocalTicks++;
+    ResolveRollback(session);
+    SimulateTick(session, session.Tick);
+    session.Tick++;
+    session.Stats.Ticks++;
+    UpdateConfirmed(session);
+    return true;
+}
+
+void ResolveRollback(RollbackSession &session)
+{
+    int from = session.FirstMispredicted;
+    if (from >= 0)
+    {
+        auto start = std::chrono::steady_clock::now();
+        session.State = session.Saved[from % ROLLBACK_RING];
+        for (int t = from; t < session.Tick; t++)
+        {
+            SimulateTick(session, t);
+        }
+        session.FirstMispredicted = -1;
+
+        RollbackStats &stats = session.Stats;
+        stats.Rollbacks++;
+        stats.ResimulatedTicks += session.Tick - from;
+        stats.MaxDepth = std::max(stats.MaxDepth, session.Tick - from);
+        stats.ResimulateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    UpdateConfirmed(session);
+}
+
+void MakeInputMessage(RollbackSession const &session, InputMessage &message)
+{
+    message.FirstTick = std::max(session.Acked, session.LocalTicks - ROLLBACK_RING);
+    message.Count = session.LocalTicks - message.FirstTick;
+    for (int i = 0; i < message.Count; i++)
+    {
+        message.Inputs[i] = session.Inputs[session.LocalSide][(message.FirstTick + i) % ROLLBACK_RING];
+    }
+    message.Ack = session.RemoteTicks;
+    message.ConfirmedTick = session.Confirmed;
+    message.ConfirmedChecksum = session.Checksums[session.Confirmed % ROLLBACK_RING];
+}
+
+void ReceiveInputMessage(RollbackSession &session, InputMessage const &message)
+{
+    if (message.Ack > session.Acked)
+    {
+        session.Acked = std::min(message.Ack, session.LocalTicks);
+    }
+
+    // Inputs are taken strictly in order, anything after a gap comes again with the next message.
+    // Slots of ticks older than the rollback window are free, newer ones would overwrite live ticks.
+    int remote = 1 - session.LocalSide;
+    int limit = session.Tick - ROLLBACK_MAX_AHEAD + ROLLBACK_RING;
+    for (int i = 0; i < message.Count; i++)
+    {
+        int t = message.FirstTick + i;
+        if (t < session.RemoteTicks)
+        {
+            continue;
+        }
+        if (t > session.RemoteTicks || t >= limit)
+        {
+            break;
+        }
+        int slot = t % ROLLBACK_RING;
+        if (t < session.Tick && message.Inputs[i] != session.Inputs[remote][slot] &&
+            (session.FirstMispredicted < 0 || t < session.FirstMispredicted))
+        {
+            session.FirstMispredicted = t;
+        }
+        session.Inputs[remote][slot] = message.Inputs[i];
+        session.RemoteTicks++;
+    }
+
+    int tick = message.ConfirmedTick;
+    RollbackStats &stats = session.Stats;
+    if (tick <= session.Confirmed && tick > session.Confirmed - ROLLBACK_RING)
+    {
+        if (session.Checksums[tick % ROLLBACK_RING] != message.ConfirmedChecksum)
+        {
+            stats.Desyncs++;
+            if (stats.FirstDesyncTick < 0 || tick < stats.FirstDesyncTick)
+            {
+                stats.FirstDesyncTick = tick;
+            }
+        }
+        else if (tick > stats.LastAgreedTick && (stats.FirstDesyncTick < 0 || tick < stats.FirstDesyncTick))
+        {
+            stats.LastAgreedTick = tick;
+        }
+    }
+}
+
+static void PutU32(unsigned char *buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        buffer[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint32_t GetU32(unsigned char const *buffer)
+{
+    return buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint32_t)buffer[3] << 24;
+}
+
+// Little endian: magic, first tick, count, ack, confirmed tick, checksum, then one PackInput byte per tick
+int WriteInputMessage(InputMessage const &message, unsigned char *buffer)
+{
+    PutU32(buffer, MESSAGE_MAGIC);
+    PutU32(buffer + 4, (uint32_t)message.FirstTick);
+    PutU32(buffer + 8, (uint32_t)message.Count);
+    PutU32(buffer + 12, (uint32_t)message.Ack);
+    PutU32(buffer + 16, (uint32_t)message.ConfirmedTick);
+    PutU32(buffer + 20, message.ConfirmedChecksum);
+    memcpy(buffer + 24, message.Inputs, message.Count);
+    return 24 + message.Count;
+}
+
+bool ReadInputMessage(InputMessage &message, unsigned char const *buffer, int size)
+{
+    if (size < 24 || GetU32(buffer) != MESSAGE_MAGIC)
+    {
+        return false;
+    }
+    message.FirstTick = (int)GetU32(buffer + 4);
+    message.Count = (int)GetU32(buffer + 8);
+    message.Ack = (int)GetU32(buffer + 12);
+    message.ConfirmedTick = (int)GetU32(buffer + 16);
+    message.ConfirmedChecksum = GetU32(buffer + 20);
+    if (message.FirstTick < 0 || message.Count < 0 || message.Count > ROLLBACK_RING || size != 24 + message.Count)
+    {
+        return false;
+    }
+    memcpy(message.Inputs, buffer + 24, message.Count);
+    return true;
+}
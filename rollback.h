@@ -0,0 +1,75 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "versus.h"
+#include <stdint.h>
+
+// GGPO-style rollback for two-player games: every tick runs at once with the remote player's input
+// guessed as their last known one (without presses). When the real input arrives and differs, the
+// session goes back to the state saved at that tick and simulates up to the present again.
+int const ROLLBACK_RING = 64;       // Ticks of saved states and inputs
+int const ROLLBACK_MAX_AHEAD = 16;  // Most ticks the local side runs ahead of the remote input it has
+int const ROLLBACK_MAX_DELAY = 8;   // Largest local input delay
+int const INPUT_MESSAGE_SIZE = 24 + ROLLBACK_RING;
+
+struct RollbackStats
+{
+    long long Ticks;            // Ticks advanced
+    long long Stalls;           // Ticks refused because the remote side was too far behind
+    long long Rollbacks;        // Mispredictions corrected
+    long long ResimulatedTicks; // Ticks simulated again by them
+    int MaxDepth;               // Deepest rollback, in ticks
+    double ResimulateSeconds;   // Wall time spent simulating again
+    long long Desyncs;          // Confirmed ticks whose checksum the remote side disagreed with
+    // The sides only compare the ticks they happen to send, so the states first drifted apart somewhere
+    // after LastAgreedTick and no later than FirstDesyncTick (-1 while there is no desync)
+    int LastAgreedTick;
+    int FirstDesyncTick;
+};
+
+struct RollbackSession
+{
+    int LocalSide;
+    int InputDelay; // Local input sampled now is played this many ticks later
+    float DeltaTime;
+
+    VersusState State; // At the start of tick Tick
+    int Tick;          // Next tick to simulate
+
+    // Slot t % ROLLBACK_RING belongs to tick t
+    VersusState Saved[ROLLBACK_RING];       // State at the start of the tick
+    unsigned char Inputs[2][ROLLBACK_RING]; // PackInput of each side, guesses for unconfirmed remote ticks
+    uint32_t Checksums[ROLLBACK_RING];      // Of the confirmed state at the start of the tick
+
+    int LocalTicks;        // Local inputs known for ticks [0, LocalTicks)
+    int RemoteTicks;       // Remote inputs known for ticks [0, RemoteTicks)
+    int Acked;             // The remote side has our inputs for ticks [0, Acked)
+    int Confirmed;         // States up to the start of this tick depend on known inputs only
+    int FirstMispredicted; // Earliest tick simulated with a wrong guess, -1 when there is none
+
+    RollbackStats Stats;
+};
+
+// What one side sends every tick: its inputs the other side hasn't acknowledged yet, its own
+// acknowledgement, and the checksum of its latest confirmed state
+struct InputMessage
+{
+    int FirstTick;
+    int Count;
+    unsigned char Inputs[ROLLBACK_RING];
+    int Ack;
+    int ConfirmedTick;
+    uint32_t ConfirmedChecksum;
+};
+
+void InitRollback(RollbackSession &session, int localSide, int inputDelay, float deltaTime, uint64_t seed);
+// Plays the local input and simulates one tick, false when it has to wait for the remote side
+bool AdvanceRollback(RollbackSession &session, SimInput local);
+void ResolveRollback(RollbackSession &session); // Correct mispredictions now instead of on the next advance
+
+void MakeInputMessage(RollbackSession const &session, InputMessage &message);
+void ReceiveInputMessage(RollbackSession &session, InputMessage const &message);
+int WriteInputMessage(InputMessage const &message, unsigned char *buffer); // Returns the bytes used
+bool ReadInputMessage(InputMessage &message, unsigned char const *buffer, int size);
+
+#endif
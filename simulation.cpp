@@ -0,0 +1,542 @@
+#include "simulation.h"
+#include "collision.h"
+#include <cmath>
+
+void InitWorld(World &world, uint64_t seed)
+{
+    SeedRng(world.rng, seed);
+    SeedRng(world.effectsRng, ~seed);
+    world.goal = {.Position = {0.992f * WORLD_WIDTH, 0.5f * WORLD_HEIGHT},
+                  .Width = 0.024f * WORLD_WIDTH,
+                  .Height = 0.308f * WORLD_HEIGHT,
+                  .GoalColor = GRAY,
+                  .NetColor = WHITE};
+    world.Pause = false;
+    world.SubtractScore = false;
+    world.ShowMinus50 = false;
+    world.Minus50Timer = 0.0f;
+    world.particles = nullptr;
+    world.effects = nullptr;
+    world.events = nullptr;
+    world.trail = {};
+    ClearBrickField(world.bricks);
+    ResetWorld(world);
+}
+
+void ResetWorld(World &world)
+{
+    world.score = 0;
+    world.goals = 0;
+    world.ball = {.Position = {WORLD_WIDTH / 2, WORLD_HEIGHT / 2},
+                  .Radius = 0.008f * WORLD_WIDTH,
+                  .Speed = 0.42f * WORLD_WIDTH,
+                  .Direction = {1.0f, -1.0f},
+                  .BallColor = WHITE,
+                  .State = Ball::NORMAL,
+                  .RollTimer = 0.0f,
+                  .rollDirection = 0.0f,
+                  .spinAngle = 0.0f,
+                  .spinSpeed = 360.0f,
+                  .sparkTimer = 0.0f};
+    world.ball.Direction = BallHeading(world.ball.Direction);
+    world.keeper = {.Position = {0.96f * WORLD_WIDTH, 0.5f * WORLD_HEIGHT},
+                    .Width = 0.016f * WORLD_WIDTH,
+                    .Height = 0.056f * WORLD_HEIGHT,
+                    .Speed = 0.485f * WORLD_HEIGHT,
+                    .KeeperColor = DARKBLUE,
+                    .Motion = 0.0f};
+    RestoreBrickLevel(world.bricks);
+    if (world.particles)
+    {
+        ClearParticleStore(*world.particles);
+    }
+    world.GameOver = false;
+}
+
+void Step(World &world, SimInput input, float deltaTime)
+{
+    StepRules(world, input, deltaTime);
+    StepCollisions(world);
+
+    // Effects keep fading while paused
+    UpdateParticles(world, deltaTime);
+}
+
+void StepRules(World &world, SimInput input, float deltaTime)
+{
+    if (world.events)
+    {
+        world.events->Tick++;
+    }
+
+    if (input.TogglePause)
+    {
+        world.Pause = !world.Pause;
+        LogEvent(world, world.Pause ? EVENT_PAUSE : EVENT_RESUME, world.ball.Position);
+    }
+
+    if (world.score < 0 && !world.GameOver)
+    {
+        world.GameOver = true;
+        LogEvent(world, EVENT_GAME_OVER, world.ball.Position);
+    }
+
+    UpdateGame(world, input, deltaTime);
+    if (world.GameOver && input.Restart)
+    {
+        ResetWorld(world);
+        LogEvent(world, EVENT_RESTART, world.ball.Position);
+    }
+}
+
+void StepCollisions(World &world)
+{
+    BallWallCollision(world, world.ball);
+    BallGoalkeeperCollision(world, world.ball);
+    BallGoalCollision(world, world.ball);
+}
+
+void UpdateGame(World &world, SimInput input, float deltaTime)
+{
+    if (world.Pause || world.GameOver)
+    {
+        return;
+    }
+
+    if (world.SubtractScore)
+    {
+        world.score -= 50;
+        world.SubtractScore = false;
+    }
+
+    if (world.ShowMinus50)
+    {
+        world.Minus50Timer -= deltaTime;
+        if (world.Minus50Timer <= 0.0f)
+        {
+            world.ShowMinus50 = false;
+        }
+    }
+
+    // Update Goalkeeper
+    Goalkeeper &keeper = world.keeper;
+    float keeperY = keeper.Position.y;
+    if (input.Up && keeper.Position.y - keeper.Height / 2 > 0)
+    {
+        keeper.Position.y -= keeper.Speed * deltaTime;
+    }
+    if (input.Down && keeper.Position.y + keeper.Height / 2 < WORLD_HEIGHT)
+    {
+        keeper.Position.y += keeper.Speed * deltaTime;
+    }
+    keeper.Motion = keeper.Position.y - keeperY;
+
+    UpdateBall(world, world.ball, deltaTime);
+}
+
+static EffectLibrary MakeBuiltInEffects(void)
+{
+    EffectLibrary library = {};
+    DefaultEffects(library);
+    return library;
+}
+
+static EffectDesc const *WorldEffect(World const &world, char const *name)
+{
+    static EffectLibrary const builtIn = MakeBuiltInEffects();
+    return FindEffect(world.effects ? *world.effects : builtIn, name);
+}
+
+void CreateGoalEffect(World &world, Vector2 goalPos)
+{
+    EffectDesc const *effect = world.particles ? WorldEffect(world, "goal") : nullptr;
+    if (effect)
+    {
+        EmitEffect(*world.particles, world.effectsRng, *effect, goalPos, effect->Burst);
+    }
+}
+
+void CreateSparkEffect(World &world, Vector2 ballPos)
+{
+    EffectDesc const *effect = world.particles ? WorldEffect(world, "spark") : nullptr;
+    if (effect)
+    {
+        EmitEffect(*world.particles, world.effectsRng, *effect, ballPos, effect->Burst);
+    }
+}
+
+void LogEvent(World &world, int type, Vector2 ballPos)
+{
+    if (!world.events)
+    {
+        return;
+    }
+    GameEvent event = {};
+    event.Tick = world.events->Tick;
+    event.Type = (uint8_t)type;
+    event.Score = world.score;
+    event.Goals = world.goals;
+    event.X = ballPos.x;
+    event.Y = ballPos.y;
+    PushEvent(*world.events, event);
+}
+
+void UpdateParticles(World &world, float deltaTime)
+{
+    if (!world.particles)
+    {
+        return;
+    }
+
+    UpdateParticleStore(*world.particles, deltaTime);
+    CompactParticleStore(*world.particles);
+
+    EffectDesc const *trail = WorldEffect(world, "trail");
+    if (trail && !world.Pause && !world.GameOver && world.ball.State == Ball::NORMAL)
+    {
+        UpdateEmitter(*world.particles, world.effectsRng, *trail, world.trail, world.ball.Position, deltaTime);
+    }
+}
+
+void UpdateBall(World &world, Ball &ball, float deltaTime)
+{
+    Goal &goal = world.goal;
+
+    // Update ball
+    if (ball.State == Ball::NORMAL)
+    {
+        // Swept move, so fast balls bounce off the keeper instead of passing through it
+        bool saved = false;
+        int bricks = world.bricks.Live.Remaining;
+        int outcome = SweepBall(MakeBallArena(world), ball.Position, ball.Direction, ball.Speed * deltaTime, saved);
+        if (saved)
+        {
+            world.score += 100;
+            LogEvent(world, EVENT_SAVE, ball.Position);
+        }
+        bricks -= world.bricks.Live.Remaining;
+        world.score += 20 * bricks;
+        for (int i = 0; i < bricks; i++)
+        {
+            LogEvent(world, EVENT_BRICK, ball.Position);
+        }
+        if (bricks > 0 && world.bricks.Live.Remaining == 0)
+        {
+            // Cleared, the next wave is the same level again
+            RestoreBrickLevel(world.bricks);
+        }
+        ball.spinAngle = 0.0f;
+        if (outcome == SWEEP_GOAL)
+        {
+            BallScored(world, ball);
+        }
+        else if (outcome == SWEEP_MISS)
+        {
+            BallMissed(world, ball);
+        }
+    }
+    else if (ball.State == Ball::ROLLING)
+    {
+        ball.RollTimer -= deltaTime;
+        float reducedSpeed = ball.Speed * 0.2f * BALL_Y_SCALE;
+        float newY = ball.Position.y + ball.rollDirection * reducedSpeed * deltaTime;
+
+        float goalTop = goal.Position.y - goal.Height / 2 + ball.Radius;
+        float goalBottom = goal.Position.y + goal.Height / 2 - ball.Radius;
+        if (newY < goalTop)
+        {
+            newY = goalTop;
+            ball.rollDirection = 1.0f; // Reverse direction to move down
+        }
+        else if (newY > goalBottom)
+        {
+            newY = goalBottom;
+            ball.rollDirection = -1.0f; // Reverse direction to move up
+        }
+        ball.Position.y = newY;
+
+        // Keep ball at goal's x-position
+        ball.Position.x = goal.Position.x - ball.Radius;
+
+        ball.spinAngle += ball.spinSpeed * deltaTime;
+
+        if (ball.spinAngle >= 360.0f)
+        {
+            ball.spinAngle -= 360.0f;
+        }
+
+        if (ball.RollTimer <= 0.0f)
+        {
+            // Transition to SPARKING state
+            ball.Position = (Vector2){WORLD_WIDTH / 2, WORLD_HEIGHT / 2};
+            ball.State = Ball::SPARKING;
+            ball.sparkTimer = 1.0f; // 1-second sparking effect
+            CreateSparkEffect(world, ball.Position);
+        }
+    }
+    else if (ball.State == Ball::SPARKING)
+    {
+        ball.sparkTimer -= deltaTime;
+        if (ball.sparkTimer <= 0.0f)
+        {
+            // Transition back to NORMAL state
+            ball.State = Ball::NORMAL;
+            ball.Direction = (Vector2){-1.0f, (float)RandomRange(world.rng, -100, 100) / 100.0f};
+            ball.Direction = BallHeading(ball.Direction);
+        }
+    }
+}
+
+void BallWallCollision(World &world, Ball &ball)
+{
+    // Ball-wall collision
+    if (ball.Position.y + ball.Radius >= WORLD_HEIGHT || ball.Position.y - ball.Radius <= 0)
+    {
+        ball.Direction.y = -ball.Direction.y;
+        ball.Position.y = ball.Position.y + ball.Radius >= WORLD_HEIGHT ? WORLD_HEIGHT - ball.Radius : ball.Radius;
+    }
+    if (ball.Position.x - ball.Radius <= 0)
+    {
+        ball.Direction.x = -ball.Direction.x;
+        ball.Position.x = ball.Radius;
+    }
+
+    if (ball.Position.x + ball.Radius >= WORLD_WIDTH && ball.State == Ball::NORMAL)
+    {
+        BallMissed(world, ball);
+    }
+}
+
+void BallGoalkeeperCollision(World &world, Ball &ball)
+{
+    // Ball-goalkeeper collision. The sweep handles world.ball, this catches balls that got onto the keeper's
+    // front without one (extra balls pushed by others). Ones already heading away or beside it were resolved.
+    Rectangle keeperRect = MakeBallArena(world).Keeper;
+    if (ball.State == Ball::NORMAL && ball.Direction.x > 0.0f && ball.Position.x < keeperRect.x &&
+        SimCheckCollisionCircleRec(ball.Position, ball.Radius, keeperRect))
+    {
+        ball.Direction.x = -ball.Direction.x;
+        ball.Position.x = keeperRect.x - ball.Radius;
+        world.score += 100;
+        LogEvent(world, EVENT_SAVE, ball.Position);
+    }
+}
+
+void BallGoalCollision(World &world, Ball &ball)
+{
+    // Ball-goal collision
+    Rectangle goalRect = MakeBallArena(world).Goal;
+    if (ball.State == Ball::NORMAL && SimCheckCollisionCircleRec(ball.Position, ball.Radius, goalRect))
+    {
+        BallScored(world, ball);
+    }
+}
+
+void BallScored(World &world, Ball &ball)
+{
+    Goal &goal = world.goal;
+
+    world.goals++;
+    CreateGoalEffect(world, goal.Position);
+    LogEvent(world, EVENT_GOAL, ball.Position);
+
+    ball.Position.x = goal.Position.x - ball.Radius;
+    ball.Position.y = goal.Position.y;
+    ball.State = Ball::ROLLING;
+    ball.RollTimer = 4.0f;
+    ball.rollDirection = (ball.Direction.y >= 0) ? 1.0f : -1.0f;
+}
+
+void BallMissed(World &world, Ball &ball)
+{
+    LogEvent(world, EVENT_MISS, ball.Position);
+    world.ShowMinus50 = true;
+    world.Minus50Timer = 1.0f;
+    world.SubtractScore = true;
+    ball.Position = (Vector2){WORLD_WIDTH / 2, WORLD_HEIGHT / 2};
+    ball.State = Ball::SPARKING;
+    ball.sparkTimer = 1.0f; // 1-second sparking effect
+    CreateSparkEffect(world, ball.Position);
+}
+
+BallArena MakeBallArena(World &world)
+{
+    Goalkeeper const &keeper = world.keeper;
+    Goal const &goal = world.goal;
+
+    BallArena arena;
+    arena.Radius = world.ball.Radius;
+    arena.Keeper = {keeper.Position.x - keeper.Width / 2, keeper.Position.y - keeper.Height / 2, keeper.Width,
+                    keeper.Height};
+    arena.Goal = {goal.Position.x - goal.Width, goal.Position.y - goal.Height / 2, goal.Width, goal.Height};
+    arena.KeeperMotion = keeper.Motion;
+    arena.Bricks = world.bricks.Live.Remaining > 0 ? &world.bricks : nullptr;
+    return arena;
+}
+
+// The keeper moves before the ball, so it can end up on it. The ball is carried past the face the keeper moved
+// with, or squeezed out the front, heading away, when a wall leaves no room there. Neither is a save.
+static void PushOutOfKeeper(BallArena const &arena, Vector2 &position, Vector2 &direction, float skin)
+{
+    Rectangle const &keeper = arena.Keeper;
+    float radius = arena.Radius;
+    bool up = arena.KeeperMotion < 0.0f;
+    float y = up ? keeper.y - radius - skin : keeper.y + keeper.height + radius + skin;
+    bool room = y - radius >= 0.0f && y + radius <= WORLD_HEIGHT;
+    if (arena.KeeperMotion != 0.0f && position.x >= keeper.x && room)
+    {
+        position.y = y;
+        direction.y = up ? -fabsf(direction.y) : fabsf(direction.y);
+    }
+    else
+    {
+        position.x = keeper.x - radius - skin;
+        direction.x = -fabsf(direction.x);
+    }
+}
+
+int SweepBall(BallArena const &arena, Vector2 &position, Vector2 &direction, float distance, bool &saved)
+{
+    enum
+    {
+        TOP_WALL,
+        BOTTOM_WALL,
+        LEFT_WALL,
+        KEEPER,
+        GOAL,
+        MISS_LINE,
+        SURFACE_COUNT,
+        BRICK = SURFACE_COUNT
+    };
+    float const skin = 0.01f; // Distance left between ball and surface after a bounce
+    float const width = WORLD_WIDTH;
+    float const height = WORLD_HEIGHT;
+    Rectangle surfaces[SURFACE_COUNT] = {{-width, -height, 3 * width, height}, {-width, height, 3 * width, height},
+                                         {-width, -height, width, 3 * height}, arena.Keeper,
+                                         arena.Goal,                           {width, -height, width, 3 * height}};
+
+    if (SimCheckCollisionCircleRec(position, arena.Radius, arena.Keeper))
+    {
+        PushOutOfKeeper(arena, position, direction, skin);
+    }
+
+    float remaining = 1.0f;
+    int outcome = SWEEP_MOVED;
+    for (int bounce = 0; bounce < MAX_SWEEP_BOUNCES && remaining > 0.0f; bounce++)
+    {
+        Vector2 delta = {direction.x * distance * remaining, direction.y * distance * remaining};
+
+        // Bounds of the whole move, most ticks touch nothing and stop here
+        float minX = fminf(position.x, position.x + delta.x) - arena.Radius;
+        float maxX = fmaxf(position.x, position.x + delta.x) + arena.Radius;
+        float minY = fminf(position.y, position.y + delta.y) - arena.Radius;
+        float maxY = fmaxf(position.y, position.y + delta.y) + arena.Radius;
+
+        SweepHit first = {false, 1.0f, {0.0f, 0.0f}};
+        int touched = -1;
+        for (int i = 0; i < SURFACE_COUNT; i++)
+        {
+            Rectangle const &rec = surfaces[i];
+            if (maxX < rec.x || minX > rec.x + rec.width || maxY < rec.y || minY > rec.y + rec.height)
+            {
+                continue;
+            }
+
+            SweepHit hit = SweepCircleRec(position, delta, arena.Radius, rec);
+            bool solid = i <= KEEPER;
+            // Solid surfaces we are already moving away from can't be hit again
+            if (hit.Hit && (!solid || hit.Normal.x * delta.x + hit.Normal.y * delta.y < 0.0f) &&
+                (touched < 0 || hit.Time < first.Time))
+            {
+                first = hit;
+                touched = i;
+            }
+        }
+
+        // Bricks bounce like walls, only the cells along the move are looked at
+        int brickColumn = 0;
+        int brickRow = 0;
+        if (arena.Bricks)
+        {
+            SweepHit hit = SweepBricks(*arena.Bricks, position, delta, arena.Radius, brickColumn, brickRow);
+            if (hit.Hit && (touched < 0 || hit.Time < first.Time))
+            {
+                first = hit;
+                touched = BRICK;
+            }
+        }
+
+        if (touched < 0)
+        {
+            position.x += delta.x;
+            position.y += delta.y;
+            break;
+        }
+
+        position.x += delta.x * first.Time;
+        position.y += delta.y * first.Time;
+        if (touched == GOAL || touched == MISS_LINE)
+        {
+            outcome = touched == GOAL ? SWEEP_GOAL : SWEEP_MISS;
+            break;
+        }
+
+        bool shot = direction.x > 0.0f;
+        float along = direction.x * first.Normal.x + direction.y * first.Normal.y;
+        direction.x -= 2 * along * first.Normal.x;
+        direction.y -= 2 * along * first.Normal.y;
+        position.x += first.Normal.x * skin;
+        position.y += first.Normal.y * skin;
+
+        // Only a shot the keeper's front turns back is a save, grazing its top, bottom or a corner isn't
+        if (touched == KEEPER && first.Normal.x < 0.0f && shot && direction.x < 0.0f)
+        {
+            saved = true;
+        }
+
+        if (touched == BRICK)
+        {
+            RemoveBrick(*arena.Bricks, brickColumn, brickRow);
+        }
+        remaining *= 1.0f - first.Time;
+    }
+
+    return outcome;
+}
+
+Vector2 SimNormalize(Vector2 v)
+{
+    float length = sqrtf(v.x * v.x + v.y * v.y);
+    if (length > 0.0f)
+    {
+        v.x /= length;
+        v.y /= length;
+    }
+    return v;
+}
+
+Vector2 BallHeading(Vector2 direction)
+{
+    direction = SimNormalize(direction);
+    return {direction.x, direction.y * BALL_Y_SCALE};
+}
+
+bool SimCheckCollisionCircleRec(Vector2 center, float radius, Rectangle rec)
+{
+    float halfWidth = rec.width / 2.0f;
+    float halfHeight = rec.height / 2.0f;
+    float dx = fabsf(center.x - (rec.x + halfWidth));
+    float dy = fabsf(center.y - (rec.y + halfHeight));
+
+    if (dx > halfWidth + radius || dy > halfHeight + radius)
+    {
+        return false;
+    }
+    if (dx <= halfWidth || dy <= halfHeight)
+    {
+        return true;
+    }
+
+    float cornerDistanceSq = (dx - halfWidth) * (dx - halfWidth) + (dy - halfHeight) * (dy - halfHeight);
+    return cornerDistanceSq <= radius * radius;
+}
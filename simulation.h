@@ -0,0 +1,144 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+// Game simulation without any window, input or GL dependency.
+// Only the plain types (Vector2, Color, Rectangle) are taken from raylib.h,
+// so this module links without libraylib and runs on headless machines.
+#include "brick_field.h"
+#include "effects.h"
+#include "event_log.h"
+#include "particles.h"
+#include "raylib.h"
+#include "rng.h"
+
+// Fixed size of the pitch in world units, independent of the window.
+// One unit is one pixel of the original 1250x650 window.
+float const WORLD_WIDTH = 1250.0f;
+float const WORLD_HEIGHT = 650.0f;
+// The ball crosses the pitch as fast along y as along x, like it did in the original window-relative rules:
+// one unit of Ball::Speed along x is BALL_Y_SCALE units along y
+float const BALL_Y_SCALE = WORLD_HEIGHT / WORLD_WIDTH;
+
+struct Ball
+{
+    Vector2 Position;
+    float Radius;
+    float Speed;       // World units per second along x
+    Vector2 Direction; // From BallHeading, the velocity is Speed * Direction
+    Color BallColor;
+    enum
+    {
+        NORMAL,
+        ROLLING,
+        SPARKING
+    } State;
+    float RollTimer;
+    float rollDirection;
+    float spinAngle;
+    float spinSpeed;
+    float sparkTimer;
+};
+
+struct Goalkeeper
+{
+    Vector2 Position;
+    float Width;
+    float Height;
+    float Speed;
+    Color KeeperColor;
+    float Motion; // How far Position.y moved in the last tick
+};
+
+struct Goal
+{
+    Vector2 Position;
+    float Width;
+    float Height;
+    Color GoalColor;
+    Color NetColor;
+};
+
+// Everything the game rules read or write
+struct World
+{
+    struct Ball ball;
+    struct Goalkeeper keeper;
+    struct Goal goal;
+    BrickField bricks; // Empty unless a level was loaded into it, +20 per brick broken
+
+    // Where goal and spark effects go, null when nobody draws them (headless runs)
+    ParticleStore *particles;
+    EffectLibrary const *effects; // null = built-in effects
+    EffectEmitter trail;          // "trail" effect behind the ball in play, if the library has one
+    EventRing *events;            // Where saves, goals, pauses... are reported, null when nobody listens
+
+    int score;
+    int goals;
+    bool Pause;
+    bool SubtractScore;
+    bool ShowMinus50;
+    float Minus50Timer;
+    bool GameOver;
+
+    // Gameplay randomness is kept apart from cosmetic randomness, so runs with and
+    // without a particle store consume the same gameplay numbers
+    Rng rng;
+    Rng effectsRng;
+};
+
+// Player intent for one step, sampled by whoever drives the simulation
+struct SimInput
+{
+    bool Up;
+    bool Down;
+    bool TogglePause;
+    bool Restart;
+};
+
+// Surfaces a moving ball can touch during one tick, besides the pitch edges
+struct BallArena
+{
+    float Radius;
+    Rectangle Keeper;
+    Rectangle Goal;
+    float KeeperMotion; // Keeper's move this tick, already made, a ball it ran into is pushed out along it
+    BrickField *Bricks; // null = none, bricks the ball bounces off are removed
+};
+
+// How a swept ball move ended
+enum
+{
+    SWEEP_MOVED,
+    SWEEP_GOAL,
+    SWEEP_MISS
+};
+int const MAX_SWEEP_BOUNCES = 8;
+
+// Declaration
+void InitWorld(World &world, uint64_t seed);
+void ResetWorld(World &world);
+void Step(World &world, SimInput input, float deltaTime); // StepRules + StepCollisions + UpdateParticles
+void StepRules(World &world, SimInput input, float deltaTime);
+void StepCollisions(World &world);
+void UpdateGame(World &world, SimInput input, float deltaTime);
+
+// Per-ball rules, for world.ball or any extra ball sharing the world's keeper, goal and score
+void UpdateBall(World &world, Ball &ball, float deltaTime);
+void BallWallCollision(World &world, Ball &ball);
+void BallGoalkeeperCollision(World &world, Ball &ball);
+void BallGoalCollision(World &world, Ball &ball);
+void BallScored(World &world, Ball &ball);
+void BallMissed(World &world, Ball &ball);
+BallArena MakeBallArena(World &world);
+int SweepBall(BallArena const &arena, Vector2 &position, Vector2 &direction, float distance, bool &saved);
+void CreateGoalEffect(World &world, Vector2 goalPos);
+void CreateSparkEffect(World &world, Vector2 ballPos);
+void LogEvent(World &world, int type, Vector2 ballPos);
+void UpdateParticles(World &world, float deltaTime);
+
+// Helpers replacing the raylib/raymath functions the rules used to call
+Vector2 SimNormalize(Vector2 v);
+Vector2 BallHeading(Vector2 direction); // Ball::Direction for a direction in pitch widths and heights
+bool SimCheckCollisionCircleRec(Vector2 center, float radius, Rectangle rec);
+
+#endif
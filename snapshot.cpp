@@ -0,0 +1,79 @@
+#include "snapshot.h"
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots are copied as raw bytes");
+
+void SaveSnapshot(GameSnapshot &snapshot, World const &world)
+{
+    snapshot.ball = world.ball;
+    snapshot.keeper = world.keeper;
+    snapshot.goal = world.goal;
+    CopyBrickCells(snapshot.bricks, world.bricks.Live, world.bricks.Rows);
+    snapshot.trail = world.trail;
+    snapshot.score = world.score;
+    snapshot.goals = world.goals;
+    snapshot.Pause = world.Pause;
+    snapshot.SubtractScore = world.SubtractScore;
+    snapshot.ShowMinus50 = world.ShowMinus50;
+    snapshot.Minus50Timer = world.Minus50Timer;
+    snapshot.GameOver = world.GameOver;
+    snapshot.rng = world.rng;
+    snapshot.effectsRng = world.effectsRng;
+}
+
+void RestoreSnapshot(World &world, GameSnapshot const &snapshot)
+{
+    world.ball = snapshot.ball;
+    world.keeper = snapshot.keeper;
+    world.goal = snapshot.goal;
+    CopyBrickCells(world.bricks.Live, snapshot.bricks, world.bricks.Rows);
+    world.trail = snapshot.trail;
+    world.score = snapshot.score;
+    world.goals = snapshot.goals;
+    world.Pause = snapshot.Pause;
+    world.SubtractScore = snapshot.SubtractScore;
+    world.ShowMinus50 = snapshot.ShowMinus50;
+    world.Minus50Timer = snapshot.Minus50Timer;
+    world.GameOver = snapshot.GameOver;
+    world.rng = snapshot.rng;
+    world.effectsRng = snapshot.effectsRng;
+}
+
+void InitRewindBuffer(RewindBuffer &buffer, int capacity)
+{
+    buffer.Frames.assign(capacity > 0 ? capacity : 0, GameSnapshot());
+    buffer.Next = 0;
+    buffer.Count = 0;
+}
+
+void PushRewind(RewindBuffer &buffer, World const &world)
+{
+    int capacity = (int)buffer.Frames.size();
+    if (capacity == 0)
+    {
+        return;
+    }
+    SaveSnapshot(buffer.Frames[buffer.Next], world);
+    buffer.Next = (buffer.Next + 1) % capacity;
+    if (buffer.Count < capacity)
+    {
+        buffer.Count++;
+    }
+}
+
+int Rewind(RewindBuffer &buffer, World &world, int ticks)
+{
+    if (ticks > buffer.Count)
+    {
+        ticks = buffer.Count;
+    }
+    if (ticks <= 0)
+    {
+        return 0;
+    }
+    int capacity = (int)buffer.Frames.size();
+    buffer.Next = (buffer.Next - ticks + capacity) % capacity;
+    buffer.Count -= ticks;
+    RestoreSnapshot(world, buffer.Frames[buffer.Next]);
+    return ticks;
+}
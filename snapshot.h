@@ -0,0 +1,45 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "simulation.h"
+#include <vector>
+
+// Everything the rules carry from one tick to the next, as one trivially copyable block.
+// Particles are cosmetic and stay out: after a restore the live ones simply keep fading.
+// World's particle store and effect library pointers are wiring, not state, and are left alone.
+struct GameSnapshot
+{
+    Ball ball;
+    Goalkeeper keeper;
+    Goal goal;
+    BrickCells bricks; // Rows past the level's are left as they were
+    EffectEmitter trail;
+    int score;
+    int goals;
+    bool Pause;
+    bool SubtractScore;
+    bool ShowMinus50;
+    float Minus50Timer;
+    bool GameOver;
+    Rng rng;
+    Rng effectsRng;
+};
+
+// Snapshots of the last ticks, the oldest overwritten first. Memory is only allocated by InitRewindBuffer.
+struct RewindBuffer
+{
+    std::vector<GameSnapshot> Frames;
+    int Next;  // Slot the next push goes to
+    int Count; // Ticks that can be rewound, up to Frames.size()
+};
+
+void SaveSnapshot(GameSnapshot &snapshot, World const &world);
+void RestoreSnapshot(World &world, GameSnapshot const &snapshot);
+
+void InitRewindBuffer(RewindBuffer &buffer, int capacity);
+void PushRewind(RewindBuffer &buffer, World const &world); // Before every tick, with the state it starts from
+// Goes back to the start of the tick `ticks` pushes ago and forgets everything newer.
+// Returns how many ticks it went back, fewer when the buffer doesn't reach that far.
+int Rewind(RewindBuffer &buffer, World &world, int ticks);
+
+#endif
@@ -0,0 +1,418 @@
+#include "soft_render.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// 5x7 glyphs, one byte per row with the leftmost pixel in bit 4
+static char const FONT_CHARS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-:.%";
+static unsigned char const FONT_GLYPHS[][7] = {
+    {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e}, {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f}, {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},
+    {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02}, {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},
+    {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e}, {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+    {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e}, {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},
+    {0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11}, {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e}, {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f}, {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f}, {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}, {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11}, {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d}, {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e}, {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a}, {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},
+    {0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04}, {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00}, {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c}, {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},
+};
+
+static void BlendPixel(Color &dst, Color src, int blend)
+{
+    int a = src.a;
+    if (blend == BLEND_ADDITIVE)
+    {
+        // SRC_ALPHA, ONE like raylib
+        int r = dst.r + src.r * a / 255;
+        int g = dst.g + src.g * a / 255;
+        int b = dst.b + src.b * a / 255;
+        dst.r = (unsigned char)(r < 255 ? r : 255);
+        dst.g = (unsigned char)(g < 255 ? g : 255);
+        dst.b = (unsigned char)(b < 255 ? b : 255);
+        return;
+    }
+    if (a == 255)
+    {
+        dst = src;
+        return;
+    }
+    dst.r = (unsigned char)((src.r * a + dst.r * (255 - a) + 127) / 255);
+    dst.g = (unsigned char)((src.g * a + dst.g * (255 - a) + 127) / 255);
+    dst.b = (unsigned char)((src.b * a + dst.b * (255 - a) + 127) / 255);
+    dst.a = (unsigned char)(a + dst.a * (255 - a) / 255);
+}
+
+// Pixels with centers in [from, to) on one row
+static void FillSpan(Canvas &canvas, int y, float from, float to, Color color, int blend)
+{
+    if (y < 0 || y >= canvas.Height)
+    {
+        return;
+    }
+    int first = (int)ceilf(from - 0.5f);
+    int last = (int)ceilf(to - 0.5f);
+    first = first > 0 ? first : 0;
+    last = last < canvas.Width ? last : canvas.Width;
+    Color *row = &canvas.Pixels[(size_t)y * canvas.Width];
+    for (int x = first; x < last; x++)
+    {
+        BlendPixel(row[x], color, blend);
+    }
+}
+
+// Rows whose centers are in [top, bottom)
+static void RowRange(Canvas const &canvas, float top, float bottom, int &first, int &last)
+{
+    first = (int)ceilf(top - 0.5f);
+    last = (int)ceilf(bottom - 0.5f);
+    first = first > 0 ? first : 0;
+    last = last < canvas.Height ? last : canvas.Height;
+}
+
+void ClearCanvas(Canvas &canvas, Color color)
+{
+    std::fill(canvas.Pixels.begin(), canvas.Pixels.end(), color);
+}
+
+void CanvasFillRect(Canvas &canvas, Rectangle rect, Color color)
+{
+    int first, last;
+    RowRange(canvas, rect.y, rect.y + rect.height, first, last);
+    for (int y = first; y < last; y++)
+    {
+        FillSpan(canvas, y, rect.x, rect.x + rect.width, color, BLEND_ALPHA);
+    }
+}
+
+void CanvasFillRoundedRect(Canvas &canvas, Rectangle rect, float roundness, Color color)
+{
+    float radius = roundness * fminf(rect.width, rect.height) / 2;
+    int first, last;
+    RowRange(canvas, rect.y, rect.y + rect.height, first, last);
+    for (int y = first; y < last; y++)
+    {
+        // Distance into a corner's circle, measured from its center row
+        float center = y + 0.5f;
+        float dy = fmaxf(rect.y + radius - center, center - (rect.y + rect.height - radius));
+        float inset = dy > 0.0f ? radius - sqrtf(fmaxf(radius * radius - dy * dy, 0.0f)) : 0.0f;
+        FillSpan(canvas, y, rect.x + inset, rect.x + rect.width - inset, color, BLEND_ALPHA);
+    }
+}
+
+void CanvasFillCircle(Canvas &canvas, Vector2 center, float radius, Color color)
+{
+    int first, last;
+    RowRange(canvas, center.y - radius, center.y + radius, first, last);
+    for (int y = first; y < last; y++)
+    {
+        float dy = y + 0.5f - center.y;
+        float half = sqrtf(fmaxf(radius * radius - dy * dy, 0.0f));
+        FillSpan(canvas, y, center.x - half, center.x + half, color, BLEND_ALPHA);
+    }
+}
+
+void CanvasStrokeCircle(Canvas &canvas, Vector2 center, float radius, float thickness, Color color)
+{
+    float outer = radius + thickness / 2;
+    float inner = fmaxf(radius - thickness / 2, 0.0f);
+    int first, last;
+    RowRange(canvas, center.y - outer, center.y + outer, first, last);
+    for (int y = first; y < last; y++)
+    {
+        float dy = y + 0.5f - center.y;
+        float outerHalf = sqrtf(fmaxf(outer * outer - dy * dy, 0.0f));
+        if (fabsf(dy) >= inner)
+        {
+            FillSpan(canvas, y, center.x - outerHalf, center.x + outerHalf, color, BLEND_ALPHA);
+            continue;
+        }
+        float innerHalf = sqrtf(inner * inner - dy * dy);
+        FillSpan(canvas, y, center.x - outerHalf, center.x - innerHalf, color, BLEND_ALPHA);
+        FillSpan(canvas, y, center.x + innerHalf, center.x + outerHalf, color, BLEND_ALPHA);
+    }
+}
+
+void CanvasFillQuad(Canvas &canvas, Vector2 const corners[4], Color color, int blend)
+{
+    float top = corners[0].y, bottom = corners[0].y;
+    for (int i = 1; i < 4; i++)
+    {
+        top = fminf(top, corners[i].y);
+        bottom = fmaxf(bottom, corners[i].y);
+    }
+    int first, last;
+    RowRange(canvas, top, bottom, first, last);
+    for (int y = first; y < last; y++)
+    {
+        // A convex outline crosses a row at most twice, the span lies between the outermost crossings
+        float center = y + 0.5f;
+        float from = 1e30f, to = -1e30f;
+        for (int i = 0; i < 4; i++)
+        {
+            Vector2 a = corners[i];
+            Vector2 b = corners[(i + 1) % 4];
+            if ((a.y <= center) == (b.y <= center))
+            {
+                continue;
+            }
+            float x = a.x + (center - a.y) / (b.y - a.y) * (b.x - a.x);
+            from = fminf(from, x);
+            to = fmaxf(to, x);
+        }
+        if (from < to)
+        {
+            FillSpan(canvas, y, from, to, color, blend);
+        }
+    }
+}
+
+void CanvasDrawLine(Canvas &canvas, Vector2 from, Vector2 to, float thickness, Color color)
+{
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length == 0.0f)
+    {
+        return;
+    }
+    float nx = -dy / length * thickness / 2;
+    float ny = dx / length * thickness / 2;
+    Vector2 corners[4] = {{from.x + nx, from.y + ny}, {to.x + nx, to.y + ny}, {to.x - nx, to.y - ny},
+                          {from.x - nx, from.y - ny}};
+    CanvasFillQuad(canvas, corners, color, BLEND_ALPHA);
+}
+
+static unsigned char const *FindGlyph(char c)
+{
+    if (c >= 'a' && c <= 'z')
+    {
+        c = (char)(c - 'a' + 'A');
+    }
+    char const *found = c != '\0' ? strchr(FONT_CHARS, c) : nullptr;
+    return found ? FONT_GLYPHS[found - FONT_CHARS] : nullptr;
+}
+
+// Glyphs sit in a 10-unit cell like raylib's default font: 5 wide plus 1 of spacing, 1 above
+int CanvasMeasureText(char const *text, int fontSize)
+{
+    int length = (int)strlen(text);
+    return length > 0 ? (int)((length * 6 - 1) * fontSize / 10.0f) : 0;
+}
+
+void CanvasDrawText(Canvas &canvas, char const *text, float x, float y, int fontSize, Color color)
+{
+    float scale = fontSize / 10.0f;
+    for (int i = 0; text[i] != '\0'; i++)
+    {
+        unsigned char const *glyph = FindGlyph(text[i]);
+        float left = x + i * 6 * scale;
+        for (int row = 0; glyph && row < 7; row++)
+        {
+            for (int column = 0; column < 5; column++)
+            {
+                if (glyph[row] & (0x10 >> column))
+                {
+                    CanvasFillRect(canvas, {left + column * scale, y + (row + 1) * scale, scale, scale}, color);
+                }
+            }
+        }
+    }
+}
+
+Camera2D CanvasView(Canvas const &canvas)
+{
+    float scaleX = canvas.Width / WORLD_WIDTH;
+    float scaleY = canvas.Height / WORLD_HEIGHT;
+    Camera2D view = {};
+    view.zoom = scaleX < scaleY ? scaleX : scaleY;
+    view.offset = {(canvas.Width - WORLD_WIDTH * view.zoom) / 2, (canvas.Height - WORLD_HEIGHT * view.zoom) / 2};
+    return view;
+}
+
+// Scene drawing below mirrors the raylib drawing in main.cpp, keep the two in step
+
+static Vector2 ToCanvas(Camera2D const &view, Vector2 point)
+{
+    return {view.offset.x + point.x * view.zoom, view.offset.y + point.y * view.zoom};
+}
+
+static Rectangle ToCanvasRect(Camera2D const &view, Rectangle rect)
+{
+    return {view.offset.x + rect.x * view.zoom, view.offset.y + rect.y * view.zoom, rect.width * view.zoom,
+            rect.height * view.zoom};
+}
+
+// DrawRectangleLinesEx, thickness in world units
+static void StrokeRect(Canvas &canvas, Camera2D const &view, Rectangle rect, float thickness, Color color)
+{
+    float right = rect.x + rect.width - thickness;
+    float bottom = rect.y + rect.height - thickness;
+    CanvasFillRect(canvas, ToCanvasRect(view, {rect.x, rect.y, rect.width, thickness}), color);
+    CanvasFillRect(canvas, ToCanvasRect(view, {rect.x, bottom, rect.width, thickness}), color);
+    CanvasFillRect(canvas, ToCanvasRect(view, {rect.x, rect.y, thickness, rect.height}), color);
+    CanvasFillRect(canvas, ToCanvasRect(view, {right, rect.y, thickness, rect.height}), color);
+}
+
+static void RenderField(Canvas &canvas, Camera2D const &view, World const &world)
+{
+    CanvasFillRect(canvas, ToCanvasRect(view, {0, 0, WORLD_WIDTH, WORLD_HEIGHT}), (Color){0, 100, 0, 255});
+    CanvasFillRect(canvas, ToCanvasRect(view, {WORLD_WIDTH / 2 - 2, 10, 1, WORLD_HEIGHT - 22}), WHITE);
+    // GL lines stay one pixel wide at any zoom
+    CanvasStrokeCircle(canvas, ToCanvas(view, {WORLD_WIDTH / 2, WORLD_HEIGHT / 2}), WORLD_WIDTH * 0.072f * view.zoom,
+                       1.0f, WHITE);
+
+    float penaltyWidth = WORLD_WIDTH * 0.144f;
+    float penaltyHeight = world.goal.Height + WORLD_HEIGHT * 0.185f;
+    StrokeRect(canvas, view,
+               {WORLD_WIDTH - penaltyWidth - world.goal.Width + WORLD_WIDTH * 0.016f,
+                WORLD_HEIGHT / 2 - penaltyHeight / 2, penaltyWidth, penaltyHeight},
+               1, WHITE);
+    StrokeRect(canvas, view,
+               {WORLD_WIDTH * 0.008f, WORLD_HEIGHT * 0.015f, WORLD_WIDTH - WORLD_WIDTH * 0.016f,
+                WORLD_HEIGHT - WORLD_HEIGHT * 0.031f},
+               1, WHITE);
+}
+
+static void RenderBricks(Canvas &canvas, Camera2D const &view, BrickField const &bricks)
+{
+    for (int row = 0; row < bricks.Rows; row++)
+    {
+        for (int column = 0; column < bricks.Columns; column++)
+        {
+            if (HasBrick(bricks, column, row))
+            {
+                Rectangle rect = BrickRect(bricks, column, row);
+                CanvasFillRect(canvas, ToCanvasRect(view, {rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2}),
+                               ORANGE);
+            }
+        }
+    }
+}
+
+static void RenderGoal(Canvas &canvas, Camera2D const &view, Goal const &goal)
+{
+    float left = goal.Position.x - goal.Width;
+    float top = goal.Position.y - goal.Height / 2;
+    CanvasFillRect(canvas, ToCanvasRect(view, {left, top, goal.Width, goal.Height}), goal.GoalColor);
+
+    int netLines = 7;
+    float netSpacingX = goal.Width / netLines;
+    float netSpacingY = goal.Height / netLines;
+    for (int i = 1; i < netLines; i++)
+    {
+        CanvasDrawLine(canvas, ToCanvas(view, {left + i * netSpacingX, top}),
+                       ToCanvas(view, {left + i * netSpacingX, top + goal.Height}), 1.0f, goal.NetColor);
+        CanvasDrawLine(canvas, ToCanvas(view, {left, top + i * netSpacingY}),
+                       ToCanvas(view, {goal.Position.x, top + i * netSpacingY}), 1.0f, goal.NetColor);
+    }
+}
+
+static void RenderBall(Canvas &canvas, Camera2D const &view, World const &world, Vector2 position, float radius)
+{
+    CanvasFillCircle(canvas, ToCanvas(view, position), radius * view.zoom, world.ball.BallColor);
+    for (int i = 0; i < 5; i++)
+    {
+        float angle = (i * (360.0f / 5) + world.ball.spinAngle) * DEG2RAD;
+        Vector2 pentagonPos = {position.x + cosf(angle) * radius * 0.5f, position.y + sinf(angle) * radius * 0.5f};
+        CanvasFillCircle(canvas, ToCanvas(view, pentagonPos), radius * 0.3f * view.zoom, BLACK);
+    }
+}
+
+static void RenderParticles(Canvas &canvas, Camera2D const &view, ParticleStore const &store, float rotation)
+{
+    float cosAngle = cosf(rotation * DEG2RAD);
+    float sinAngle = sinf(rotation * DEG2RAD);
+    for (int c = 0; c < store.chunkCount; c++)
+    {
+        ParticleChunk const &p = *store.chunks[c];
+        int count = ChunkParticleCount(store, c);
+        for (int i = 0; i < count; i++)
+        {
+            Color color = p.color[i];
+            color.a = (unsigned char)(fminf(fmaxf(p.alpha[i], 0.0f), 1.0f) * p.color[i].a);
+            Vector2 center = ToCanvas(view, {p.x[i], p.y[i]});
+            float half = p.size[i] * view.zoom / 2;
+            float ax = (cosAngle - sinAngle) * half, ay = (sinAngle + cosAngle) * half;
+            float bx = (cosAngle + sinAngle) * half, by = (sinAngle - cosAngle) * half;
+            Vector2 corners[4] = {{center.x - ax, center.y - ay}, {center.x + bx, center.y + by},
+                                  {center.x + ax, center.y + ay}, {center.x - bx, center.y - by}};
+            CanvasFillQuad(canvas, corners, color, p.blend[i]);
+        }
+    }
+}
+
+// anchor 0 puts x at the left edge of the text, 0.5 at its center
+static void RenderHudText(Canvas &canvas, char const *text, float x, float y, int fontSize, Color color, float anchor)
+{
+    CanvasDrawText(canvas, text, x - CanvasMeasureText(text, fontSize) * anchor, y, fontSize, color);
+}
+
+static void RenderHud(Canvas &canvas, World const &world)
+{
+    float width = (float)canvas.Width;
+    float height = (float)canvas.Height;
+    char line[64];
+    snprintf(line, sizeof(line), "Score: %i", world.score);
+    RenderHudText(canvas, line, width * 0.008f, height * 0.015f, 20, WHITE, 0.0f);
+    snprintf(line, sizeof(line), "Goals: %i", world.goals);
+    RenderHudText(canvas, line, width * 0.008f, height * 0.062f, 20, WHITE, 0.0f);
+
+    if (world.Pause)
+    {
+        RenderHudText(canvas, "Game paused", width / 2, height / 2, 25, BLACK, 0.5f);
+    }
+    if (world.ball.State == Ball::ROLLING)
+    {
+        RenderHudText(canvas, "Goal", width / 2 + 250, height / 2, 30, BLACK, 0.0f);
+    }
+    if (world.ShowMinus50)
+    {
+        RenderHudText(canvas, "-50", width / 2 + 250, height / 2, 25, BLACK, 0.0f);
+    }
+    if (world.GameOver)
+    {
+        RenderHudText(canvas, "Game Over", width / 2, height / 2 - 50, 35, MAROON, 0.5f);
+        Rectangle button = {width / 2 - 100, height / 2 + 50, 200, 50};
+        CanvasFillRoundedRect(canvas, button, 0.3f, DARKBLUE);
+        RenderHudText(canvas, "Restart", button.x + button.width / 2, button.y + (button.height - 20) / 2, 20, BLACK,
+                      0.5f);
+    }
+}
+
+void RenderWorld(Canvas &canvas, World const &world, Ball const *extraBalls, int extraCount, float rotation)
+{
+    Camera2D view = CanvasView(canvas);
+    ClearCanvas(canvas, BLACK);
+    RenderField(canvas, view, world);
+    RenderGoal(canvas, view, world.goal);
+    RenderBricks(canvas, view, world.bricks);
+
+    Goalkeeper const &keeper = world.keeper;
+    CanvasFillRect(canvas,
+                   ToCanvasRect(view, {keeper.Position.x - keeper.Width / 2 - WORLD_WIDTH * 0.016f,
+                                   keeper.Position.y - keeper.Height / 5, keeper.Width, keeper.Height}),
+                   keeper.KeeperColor);
+    RenderBall(canvas, view, world, world.ball.Position, world.ball.Radius);
+    for (int i = 0; i < extraCount; i++)
+    {
+        RenderBall(canvas, view, world, extraBalls[i].Position, extraBalls[i].Radius);
+    }
+
+    if (world.particles)
+    {
+        RenderParticles(canvas, view, *world.particles, rotation);
+    }
+    RenderHud(canvas, world);
+}
@@ -0,0 +1,29 @@
+#ifndef SOFT_RENDER_H
+#define SOFT_RENDER_H
+
+// CPU rasterizer for headless runs: draws a frame of the game into a Canvas, no window or GPU needed.
+// Close to what the raylib build shows but not pixel-identical to it, compare soft renders only
+// against soft renders.
+#include "canvas.h"
+#include "simulation.h"
+
+// Primitives, in canvas pixels. A pixel is covered when its center is inside the shape.
+void ClearCanvas(Canvas &canvas, Color color);
+void CanvasFillRect(Canvas &canvas, Rectangle rect, Color color);
+void CanvasFillRoundedRect(Canvas &canvas, Rectangle rect, float roundness, Color color); // As DrawRectangleRounded
+void CanvasFillCircle(Canvas &canvas, Vector2 center, float radius, Color color);
+void CanvasStrokeCircle(Canvas &canvas, Vector2 center, float radius, float thickness, Color color);
+void CanvasDrawLine(Canvas &canvas, Vector2 from, Vector2 to, float thickness, Color color);
+void CanvasFillQuad(Canvas &canvas, Vector2 const corners[4], Color color, int blend); // Convex, any winding
+// Built-in 5x7 font scaled to fontSize, lowercase drawn as uppercase
+void CanvasDrawText(Canvas &canvas, char const *text, float x, float y, int fontSize, Color color);
+int CanvasMeasureText(char const *text, int fontSize);
+
+// World-to-canvas transform, letterboxed like the window's worldView
+Camera2D CanvasView(Canvas const &canvas);
+
+// The frame DrawGame draws without debug overlays: pitch, goal, keeper, balls, particles and HUD.
+// rotation: particle spin in degrees, the window uses GetTime() * 90.
+void RenderWorld(Canvas &canvas, World const &world, Ball const *extraBalls, int extraCount, float rotation);
+
+#endif
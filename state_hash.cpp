@@ -0,0 +1,114 @@
+#include "state_hash.h"
+#include <cstring>
+
+static char const *const FIELD_NAMES[STATE_FIELD_COUNT] = {
+    "ball.position", "ball.direction", "ball.speed", "ball.motion", "keeper", "goal", "score", "flags", "rng", "bricks",
+};
+
+// One 32-bit word at a time (murmur3 mixing), every field is a handful of words
+static uint32_t MixWord(uint32_t hash, uint32_t word)
+{
+    word *= 0xcc9e2d51u;
+    word = (word << 15) | (word >> 17);
+    word *= 0x1b873593u;
+    hash ^= word;
+    hash = (hash << 13) | (hash >> 19);
+    return hash * 5 + 0xe6546b64u;
+}
+
+static uint32_t MixFloat(uint32_t hash, float value)
+{
+    value += 0.0f; // -0 + 0 is +0
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return MixWord(hash, bits);
+}
+
+static uint32_t MixVector(uint32_t hash, Vector2 v)
+{
+    return MixFloat(MixFloat(hash, v.x), v.y);
+}
+
+static uint32_t Finish(uint32_t hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    return hash ^ (hash >> 16);
+}
+
+void HashWorldState(World const &world, StateHash &hash)
+{
+    Ball const &ball = world.ball;
+    uint32_t *fields = hash.Fields;
+    fields[STATE_BALL_POSITION] = Finish(MixVector(STATE_BALL_POSITION, ball.Position));
+    fields[STATE_BALL_DIRECTION] = Finish(MixVector(STATE_BALL_DIRECTION, ball.Direction));
+    fields[STATE_BALL_SPEED] = Finish(MixFloat(MixFloat(STATE_BALL_SPEED, ball.Speed), ball.Radius));
+
+    uint32_t motion = MixWord(STATE_BALL_MOTION, (uint32_t)ball.State);
+    motion = MixFloat(motion, ball.RollTimer);
+    motion = MixFloat(motion, ball.rollDirection);
+    motion = MixFloat(motion, ball.spinAngle);
+    motion = MixFloat(motion, ball.spinSpeed);
+    fields[STATE_BALL_MOTION] = Finish(MixFloat(motion, ball.sparkTimer));
+
+    Goalkeeper const &keeper = world.keeper;
+    uint32_t keeperHash = MixVector(STATE_KEEPER, keeper.Position);
+    keeperHash = MixFloat(MixFloat(keeperHash, keeper.Width), keeper.Height);
+    fields[STATE_KEEPER] = Finish(MixFloat(keeperHash, keeper.Speed));
+
+    Goal const &goal = world.goal;
+    uint32_t goalHash = MixVector(STATE_GOAL, goal.Position);
+    fields[STATE_GOAL] = Finish(MixFloat(MixFloat(goalHash, goal.Width), goal.Height));
+
+    fields[STATE_SCORE] = Finish(MixWord(MixWord(STATE_SCORE, (uint32_t)world.score), (uint32_t)world.goals));
+
+    uint32_t flags = world.Pause | world.SubtractScore << 1 | world.ShowMinus50 << 2 | world.GameOver << 3;
+    fields[STATE_FLAGS] = Finish(MixFloat(MixWord(STATE_FLAGS, flags), world.Minus50Timer));
+
+    uint32_t rng = STATE_RNG;
+    for (int i = 0; i < 4; i++)
+    {
+        rng = MixWord(rng, world.rng.s[i]);
+    }
+    fields[STATE_RNG] = Finish(rng);
+
+    // Rows past the level's are always empty
+    BrickCells const &bricks = world.bricks.Live;
+    uint32_t brickHash = MixWord(STATE_BRICKS, (uint32_t)bricks.Remaining);
+    for (int row = 0; row < world.bricks.Rows; row++)
+    {
+        for (int word = 0; word < BRICK_ROW_WORDS; word++)
+        {
+            brickHash = MixWord(brickHash, (uint32_t)bricks.Rows[row][word]);
+            brickHash = MixWord(brickHash, (uint32_t)(bricks.Rows[row][word] >> 32));
+        }
+    }
+    fields[STATE_BRICKS] = Finish(brickHash);
+}
+
+uint32_t CombineStateHash(StateHash const &hash)
+{
+    uint32_t combined = STATE_FIELD_COUNT;
+    for (int field = 0; field < STATE_FIELD_COUNT; field++)
+    {
+        combined = MixWord(combined, hash.Fields[field]);
+    }
+    return Finish(combined);
+}
+
+char const *StateFieldName(int field)
+{
+    return field >= 0 && field < STATE_FIELD_COUNT ? FIELD_NAMES[field] : "?";
+}
+
+void HashBytes(uint32_t &hash, void const *data, size_t size)
+{
+    unsigned char const *bytes = (unsigned char const *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u; // FNV-1a
+    }
+}
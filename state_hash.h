@@ -0,0 +1,40 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include "simulation.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Hash of the gameplay state, one value per group of fields so a divergence can be named.
+// Only what the rules carry from tick to tick counts: particles, the trail and the effects RNG
+// differ between windowed and headless runs of the same inputs and are left out.
+// Floats are hashed by their bits, with -0 taken as 0.
+enum StateField
+{
+    STATE_BALL_POSITION,
+    STATE_BALL_DIRECTION,
+    STATE_BALL_SPEED,  // Speed and radius
+    STATE_BALL_MOTION, // State, roll, spin and spark timers
+    STATE_KEEPER,
+    STATE_GOAL,
+    STATE_SCORE, // Score and goals
+    STATE_FLAGS, // Pause, -50 display, game over
+    STATE_RNG,
+    STATE_BRICKS, // Bricks still standing
+    STATE_FIELD_COUNT
+};
+
+struct StateHash
+{
+    uint32_t Fields[STATE_FIELD_COUNT];
+};
+
+void HashWorldState(World const &world, StateHash &hash);
+uint32_t CombineStateHash(StateHash const &hash);
+char const *StateFieldName(int field);
+
+// FNV-1a over raw bytes for the single-value checksums, start from FNV_OFFSET_BASIS.
+uint32_t const FNV_OFFSET_BASIS = 2166136261u;
+void HashBytes(uint32_t &hash, void const *data, size_t size);
+
+#endif
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+static void SliceRange(int count, int slice, int slices, int &begin, int &end)
+{
+    begin = (int)((long long)count * slice / slices);
+    end = (int)((long long)count * (slice + 1) / slices);
+}
+
+static void WorkerLoop(ThreadPool &pool, int slice)
+{
+    int seenGeneration = 0;
+    for (;;)
+    {
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        pool.wake.wait(lock, [&] { return pool.stopping || pool.generation != seenGeneration; });
+        if (pool.stopping)
+        {
+            return;
+        }
+        seenGeneration = pool.generation;
+        int count = pool.jobCount;
+        int slices = (int)pool.workers.size() + 1;
+        lock.unlock();
+
+        int begin, end;
+        SliceRange(count, slice, slices, begin, end);
+        if (begin < end)
+        {
+            pool.job(begin, end);
+        }
+
+        lock.lock();
+        if (--pool.pending == 0)
+        {
+            pool.done.notify_one();
+        }
+    }
+}
+
+void StartThreadPool(ThreadPool &pool, int workerCount)
+{
+    if (workerCount < 0)
+    {
+        int cores = (int)std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 0;
+    }
+    pool.jobCount = 0;
+    pool.generation = 0;
+    pool.pending = 0;
+    pool.stopping = false;
+    for (int i = 0; i < workerCount; i++)
+    {
+        // Slice 0 belongs to the calling thread
+        pool.workers.push_back(std::thread(WorkerLoop, std::ref(pool), i + 1));
+    }
+}
+
+void StopThreadPool(ThreadPool &pool)
+{
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.stopping = true;
+    }
+    pool.wake.notify_all();
+    for (size_t i = 0; i < pool.workers.size(); i++)
+    {
+        pool.workers[i].join();
+    }
+    pool.workers.clear();
+}
+
+void RunParallel(ThreadPool &pool, int count, std::function<void(int, int)> const &job)
+{
+    int slices = (int)pool.workers.size() + 1;
+    if (slices == 1 || count < slices)
+    {
+        job(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.job = job;
+        pool.jobCount = count;
+        pool.pending = slices - 1;
+        pool.generation++;
+    }
+    pool.wake.notify_all();
+
+    int begin, end;
+    SliceRange(count, 0, slices, begin, end);
+    job(begin, end);
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.done.wait(lock, [&] { return pool.pending == 0; });
+}
@@ -0,0 +1,30 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that split an index range between them.
+// The calling thread takes a share of the work too, so a pool of 0 workers runs everything inline.
+struct ThreadPool
+{
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(int, int)> job;
+    int jobCount;
+    int generation;
+    int pending;
+    bool stopping;
+};
+
+void StartThreadPool(ThreadPool &pool, int workerCount); // workerCount < 0 = one per extra core
+void StopThreadPool(ThreadPool &pool);
+// Calls job(begin, end) on disjoint slices of [0, count) and returns when all slices are done
+void RunParallel(ThreadPool &pool, int count, std::function<void(int, int)> const &job);
+
+#endif
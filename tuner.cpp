@@ -0,0 +1,329 @@
+// Difficulty tuner: plays many headless games for every point of a parameter grid and writes
+// goals-per-minute and game-over-time distributions as CSV.
+// Usage: footballArkanoid-tuner [--ball-speed RANGE] [--keeper-speed RANGE] [--keeper-height RANGE]
+//                               [--goal-height RANGE] [--reaction RANGE] [--games N] [--max-time SECONDS]
+//                               [--tick-rate HZ] [--seed N] [--threads N] [--out FILE] [--games-csv FILE]
+//                               [--ai SKILL]
+// A RANGE is FROM:TO:STEP (inclusive) or a single value. Speeds and sizes use the factors of InitWorld:
+// ball speed in pitch widths per second (pitch heights along y), keeper speed, keeper height and goal height in
+// pitch heights.
+// The scripted keeper chases the ball as it was --reaction seconds ago. With --ai the predictive AI
+// keeper of that skill plays instead, --reaction then sets its latency. Every setting plays the same
+// seeds, so differences between settings aren't drowned in luck.
+#include "keeper_ai.h"
+#include "simulation.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+enum
+{
+    AXIS_BALL_SPEED,
+    AXIS_KEEPER_SPEED,
+    AXIS_KEEPER_HEIGHT,
+    AXIS_GOAL_HEIGHT,
+    AXIS_REACTION,
+    AXIS_COUNT
+};
+
+struct Axis
+{
+    char const *Option;
+    char const *Column;
+    std::vector<float> Values;
+};
+
+struct GameResult
+{
+    int Goals;
+    float Duration; // Seconds until game over, or the time limit
+    bool Ended;
+};
+
+static bool ParseRange(char const *text, std::vector<float> &values)
+{
+    float from, to, step;
+    values.clear();
+    int fields = sscanf(text, "%f:%f:%f", &from, &to, &step);
+    if (fields == 1)
+    {
+        values.push_back(from);
+        return true;
+    }
+    if (fields != 3 || step <= 0.0f || to < from)
+    {
+        return false;
+    }
+    // Counted rather than accumulated. The slack keeps TO when rounding lands just short of it, nothing goes past it.
+    int count = (int)floorf((to - from) / step + 1e-4f) + 1;
+    for (int i = 0; i < count; i++)
+    {
+        values.push_back(from + step * i);
+    }
+    return true;
+}
+
+static float Percentile(std::vector<float> &samples, float fraction)
+{
+    size_t rank = (size_t)(fraction * (samples.size() - 1) + 0.5f);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+// One game with the parameters of `setting` until game over or maxTime
+static GameResult PlayGame(float const setting[AXIS_COUNT], uint64_t seed, float tickRate, float maxTime, int skill)
+{
+    float deltaTime = 1.0f / tickRate;
+    World world;
+    InitWorld(world, seed);
+    world.ball.Speed = setting[AXIS_BALL_SPEED] * WORLD_WIDTH;
+    world.keeper.Speed = setting[AXIS_KEEPER_SPEED] * WORLD_HEIGHT;
+    world.keeper.Height = setting[AXIS_KEEPER_HEIGHT] * WORLD_HEIGHT;
+    world.goal.Height = setting[AXIS_GOAL_HEIGHT] * WORLD_HEIGHT;
+
+    // Ball heights of the last reaction ticks, the keeper sees the oldest
+    int delay = (int)(setting[AXIS_REACTION] * tickRate + 0.5f);
+    std::vector<float> seen(delay + 1, world.ball.Position.y);
+    KeeperAi ai;
+    InitKeeperAi(ai, skill >= 0 ? skill : KEEPER_NORMAL, seed);
+    ai.Skill.Latency = setting[AXIS_REACTION];
+
+    long ticks = (long)(maxTime * tickRate);
+    long tick = 0;
+    for (; tick < ticks && !world.GameOver; tick++)
+    {
+        seen[tick % seen.size()] = world.ball.Position.y;
+        float target = seen[(tick + 1) % seen.size()];
+        SimInput input = {};
+        if (skill >= 0)
+        {
+            input = KeeperAiInput(ai, world, deltaTime);
+        }
+        else
+        {
+            input.Up = target < world.keeper.Position.y - world.keeper.Height / 4;
+            input.Down = target > world.keeper.Position.y + world.keeper.Height / 4;
+        }
+        Step(world, input, deltaTime);
+    }
+
+    GameResult result;
+    result.Goals = world.goals;
+    result.Duration = tick * deltaTime;
+    result.Ended = world.GameOver;
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    Axis axes[AXIS_COUNT] = {
+        {"--ball-speed", "ball_speed", {0.42f}},     {"--keeper-speed", "keeper_speed", {0.485f}},
+        {"--keeper-height", "keeper_height", {0.056f}}, {"--goal-height", "goal_height", {0.308f}},
+        {"--reaction", "reaction", {0.08f}},
+    };
+    int games = 1000;
+    float maxTime = 300.0f;
+    float tickRate = 60.0f;
+    uint64_t seed = 1;
+    int threads = -1;
+    char const *outPath = nullptr;
+    char const *gamesPath = nullptr;
+    int skill = -1;
+    for (int i = 1; i < argc; i += 2)
+    {
+        // Every option takes a value
+        if (i + 1 == argc)
+        {
+            fprintf(stderr, "%s wants a value\n", argv[i]);
+            return 1;
+        }
+        bool axis = false;
+        for (int a = 0; a < AXIS_COUNT; a++)
+        {
+            if (strcmp(argv[i], axes[a].Option) == 0)
+            {
+                axis = true;
+                if (!ParseRange(argv[i + 1], axes[a].Values))
+                {
+                    fprintf(stderr, "%s wants FROM:TO:STEP or a single value\n", axes[a].Option);
+                    return 1;
+                }
+            }
+        }
+        if (axis)
+        {
+            continue;
+        }
+        if (strcmp(argv[i], "--games") == 0)
+        {
+            games = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--max-time") == 0)
+        {
+            maxTime = (float)atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0)
+        {
+            tickRate = (float)atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            seed = strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            // Total threads including the main one
+            threads = atoi(argv[i + 1]) - 1;
+            if (threads < 0)
+            {
+                fprintf(stderr, "--threads wants at least 1\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--out") == 0)
+        {
+            outPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--games-csv") == 0)
+        {
+            gamesPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--ai") == 0)
+        {
+            skill = FindKeeperSkill(argv[i + 1]);
+            if (skill < 0)
+            {
+                fprintf(stderr, "--ai wants easy, normal, hard or perfect\n");
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (games <= 0 || maxTime <= 0.0f || tickRate <= 0.0f)
+    {
+        fprintf(stderr, "--games, --max-time and --tick-rate must be positive\n");
+        return 1;
+    }
+
+    // Every combination of axis values, the last axis varying fastest
+    std::vector<std::vector<float>> settings(1, std::vector<float>());
+    for (int a = 0; a < AXIS_COUNT; a++)
+    {
+        std::vector<std::vector<float>> grown;
+        for (size_t s = 0; s < settings.size(); s++)
+        {
+            for (size_t v = 0; v < axes[a].Values.size(); v++)
+            {
+                grown.push_back(settings[s]);
+                grown.back().push_back(axes[a].Values[v]);
+            }
+        }
+        settings.swap(grown);
+    }
+    int settingCount = (int)settings.size();
+    long long total = (long long)settingCount * games;
+    if (total > 0x7fffffff)
+    {
+        fprintf(stderr, "%lld games is too many for one sweep\n", total);
+        return 1;
+    }
+
+    // Game i plays setting i % settingCount, so every thread's slice holds a mix of long and short games
+    std::vector<GameResult> results((size_t)total);
+    ThreadPool pool;
+    StartThreadPool(pool, threads);
+    auto start = std::chrono::steady_clock::now();
+    RunParallel(pool, (int)total, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            int game = i / settingCount;
+            results[i] = PlayGame(settings[i % settingCount].data(), seed + (uint64_t)game, tickRate, maxTime,
+                                    skill);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int threadCount = (int)pool.workers.size() + 1;
+    StopThreadPool(pool);
+
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "could not write %s\n", outPath);
+        return 1;
+    }
+    for (int a = 0; a < AXIS_COUNT; a++)
+    {
+        fprintf(out, "%s,", axes[a].Column);
+    }
+    fprintf(out, "games,goals_per_min_mean,goals_per_min_p10,goals_per_min_p50,goals_per_min_p90,"
+                 "game_over_fraction,game_over_time_mean,game_over_time_p10,game_over_time_p50,"
+                 "game_over_time_p90\n");
+    for (int s = 0; s < settingCount; s++)
+    {
+        std::vector<float> rates;
+        std::vector<float> overTimes;
+        double rateSum = 0.0, overSum = 0.0;
+        for (int game = 0; game < games; game++)
+        {
+            GameResult const &result = results[(size_t)game * settingCount + s];
+            float rate = result.Duration > 0.0f ? result.Goals * 60.0f / result.Duration : 0.0f;
+            rates.push_back(rate);
+            rateSum += rate;
+            if (result.Ended)
+            {
+                overTimes.push_back(result.Duration);
+                overSum += result.Duration;
+            }
+        }
+
+        for (int a = 0; a < AXIS_COUNT; a++)
+        {
+            fprintf(out, "%g,", settings[s][a]);
+        }
+        fprintf(out, "%d,%.3f,%.3f,%.3f,%.3f,%.4f", games, rateSum / games, Percentile(rates, 0.1f),
+                Percentile(rates, 0.5f), Percentile(rates, 0.9f), (double)overTimes.size() / games);
+        // Games still running at --max-time have no game-over time, the fields stay empty if none ended
+        if (overTimes.empty())
+        {
+            fprintf(out, ",,,,\n");
+            continue;
+        }
+        fprintf(out, ",%.2f,%.2f,%.2f,%.2f\n", overSum / overTimes.size(), Percentile(overTimes, 0.1f),
+                Percentile(overTimes, 0.5f), Percentile(overTimes, 0.9f));
+    }
+    if (outPath)
+    {
+        fclose(out);
+    }
+
+    if (gamesPath)
+    {
+        FILE *file = fopen(gamesPath, "w");
+        if (!file)
+        {
+            fprintf(stderr, "could not write %s\n", gamesPath);
+            return 1;
+        }
+        fprintf(file, "setting,seed,goals,duration,game_over\n");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            fprintf(file, "%d,%llu,%d,%.3f,%d\n", (int)(i % settingCount),
+                    (unsigned long long)(seed + i / settingCount), results[i].Goals, results[i].Duration,
+                    results[i].Ended ? 1 : 0);
+        }
+        fclose(file);
+    }
+
+    fprintf(stderr, "%d settings x %d games on %d threads in %.2f s (%.0f games/s)\n", settingCount, games,
+            threadCount, seconds, total / seconds);
+    return 0;
+}
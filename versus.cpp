@@ -0,0 +1,235 @@
+#include "versus.h"
+#include "collision.h"
+#include "state_hash.h"
+#include <cmath>
+
+float const VERSUS_SPEEDUP = 1.04f;  // Per save
+float const VERSUS_MAX_SPEEDUP = 2.0f;
+
+void InitVersus(VersusState &state, uint64_t seed)
+{
+    state = {};
+    SeedRng(state.rng, seed);
+    ResetVersus(state);
+}
+
+void ResetVersus(VersusState &state)
+{
+    // Same pitch, keeper and goal sizes as the single-player game, mirrored for the left side
+    World world;
+    InitWorld(world, 0);
+    state.keepers[VERSUS_RIGHT] = world.keeper;
+    state.keepers[VERSUS_LEFT] = world.keeper;
+    state.keepers[VERSUS_LEFT].Position.x = WORLD_WIDTH - world.keeper.Position.x;
+    state.keepers[VERSUS_LEFT].KeeperColor = MAROON;
+
+    state.goals[VERSUS_RIGHT] = world.goal;
+    state.goals[VERSUS_LEFT] = world.goal;
+    // Goal.Position is the back of a right-hand goal, keep it the far edge from the pitch's point of view
+    state.goals[VERSUS_LEFT].Position.x = WORLD_WIDTH - world.goal.Position.x + world.goal.Width;
+
+    state.ball = world.ball;
+    state.BaseSpeed = world.ball.Speed;
+    state.ball.Position = (Vector2){WORLD_WIDTH / 2, WORLD_HEIGHT / 2};
+    state.ball.State = Ball::SPARKING;
+    state.ball.sparkTimer = 1.0f;
+    state.ServeTo = RandomRange(state.rng, VERSUS_LEFT, VERSUS_RIGHT);
+    state.Score[VERSUS_LEFT] = 0;
+    state.Score[VERSUS_RIGHT] = 0;
+    state.Pause = false;
+    state.GameOver = false;
+}
+
+static Rectangle KeeperRect(Goalkeeper const &keeper)
+{
+    return {keeper.Position.x - keeper.Width / 2, keeper.Position.y - keeper.Height / 2, keeper.Width,
+            keeper.Height};
+}
+
+static Rectangle GoalRect(Goal const &goal)
+{
+    return {goal.Position.x - goal.Width, goal.Position.y - goal.Height / 2, goal.Width, goal.Height};
+}
+
+// SweepBall with a keeper and a goal at both ends and no miss line.
+// Returns the side whose goal the ball went into, or -1.
+static int SweepVersusBall(VersusState &state, float distance, int &saves)
+{
+    enum
+    {
+        TOP_WALL,
+        BOTTOM_WALL,
+        LEFT_WALL,
+        RIGHT_WALL,
+        LEFT_KEEPER,
+        RIGHT_KEEPER,
+        LEFT_GOAL,
+        RIGHT_GOAL,
+        SURFACE_COUNT
+    };
+    float const skin = 0.01f;
+    float const width = WORLD_WIDTH;
+    float const height = WORLD_HEIGHT;
+    Rectangle surfaces[SURFACE_COUNT] = {{-width, -height, 3 * width, height},
+                                         {-width, height, 3 * width, height},
+                                         {-width, -height, width, 3 * height},
+                                         {width, -height, width, 3 * height},
+                                         KeeperRect(state.keepers[VERSUS_LEFT]),
+                                         KeeperRect(state.keepers[VERSUS_RIGHT]),
+                                         GoalRect(state.goals[VERSUS_LEFT]),
+                                         GoalRect(state.goals[VERSUS_RIGHT])};
+
+    Vector2 &position = state.ball.Position;
+    Vector2 &direction = state.ball.Direction;
+    float radius = state.ball.Radius;
+    float remaining = 1.0f;
+    for (int bounce = 0; bounce < MAX_SWEEP_BOUNCES && remaining > 0.0f; bounce++)
+    {
+        Vector2 delta = {direction.x * distance * remaining, direction.y * distance * remaining};
+        SweepHit first = {false, 1.0f, {0.0f, 0.0f}};
+        int touched = -1;
+        for (int i = 0; i < SURFACE_COUNT; i++)
+        {
+            SweepHit hit = SweepCircleRec(position, delta, radius, surfaces[i]);
+            bool solid = i <= RIGHT_KEEPER;
+            if (hit.Hit && (!solid || hit.Normal.x * delta.x + hit.Normal.y * delta.y < 0.0f) &&
+                (touched < 0 || hit.Time < first.Time))
+            {
+                first = hit;
+                touched = i;
+            }
+        }
+
+        if (touched < 0)
+        {
+            position.x += delta.x;
+            position.y += delta.y;
+            break;
+        }
+
+        position.x += delta.x * first.Time;
+        position.y += delta.y * first.Time;
+        if (touched == LEFT_GOAL || touched == RIGHT_GOAL)
+        {
+            return touched == LEFT_GOAL ? VERSUS_LEFT : VERSUS_RIGHT;
+        }
+
+        float along = direction.x * first.Normal.x + direction.y * first.Normal.y;
+        direction.x -= 2 * along * first.Normal.x;
+        direction.y -= 2 * along * first.Normal.y;
+        position.x += first.Normal.x * skin;
+        position.y += first.Normal.y * skin;
+        if (touched == LEFT_KEEPER || touched == RIGHT_KEEPER)
+        {
+            saves++;
+        }
+        remaining *= 1.0f - first.Time;
+    }
+    return -1;
+}
+
+static void MoveKeeper(Goalkeeper &keeper, SimInput input, float deltaTime)
+{
+    if (input.Up && keeper.Position.y - keeper.Height / 2 > 0)
+    {
+        keeper.Position.y -= keeper.Speed * deltaTime;
+    }
+    if (input.Down && keeper.Position.y + keeper.Height / 2 < WORLD_HEIGHT)
+    {
+        keeper.Position.y += keeper.Speed * deltaTime;
+    }
+}
+
+void StepVersus(VersusState &state, SimInput const inputs[2], float deltaTime)
+{
+    // Either player pausing pauses both, pressing together still counts once
+    if (inputs[VERSUS_LEFT].TogglePause || inputs[VERSUS_RIGHT].TogglePause)
+    {
+        state.Pause = !state.Pause;
+    }
+    if (state.GameOver && (inputs[VERSUS_LEFT].Restart || inputs[VERSUS_RIGHT].Restart))
+    {
+        ResetVersus(state);
+        return;
+    }
+    if (state.Pause || state.GameOver)
+    {
+        return;
+    }
+
+    MoveKeeper(state.keepers[VERSUS_LEFT], inputs[VERSUS_LEFT], deltaTime);
+    MoveKeeper(state.keepers[VERSUS_RIGHT], inputs[VERSUS_RIGHT], deltaTime);
+
+    Ball &ball = state.ball;
+    if (ball.State == Ball::SPARKING)
+    {
+        ball.sparkTimer -= deltaTime;
+        if (ball.sparkTimer <= 0.0f)
+        {
+            ball.State = Ball::NORMAL;
+            ball.Speed = state.BaseSpeed;
+            float towards = state.ServeTo == VERSUS_LEFT ? -1.0f : 1.0f;
+            ball.Direction = (Vector2){towards, (float)RandomRange(state.rng, -100, 100) / 100.0f};
+            ball.Direction = BallHeading(ball.Direction);
+        }
+        return;
+    }
+
+    int saves = 0;
+    int conceded = SweepVersusBall(state, ball.Speed * deltaTime, saves);
+    for (int i = 0; i < saves; i++)
+    {
+        ball.Speed = fminf(ball.Speed * VERSUS_SPEEDUP, state.BaseSpeed * VERSUS_MAX_SPEEDUP);
+    }
+    if (conceded >= 0)
+    {
+        int scorer = 1 - conceded;
+        state.Score[scorer]++;
+        state.GameOver = state.Score[scorer] >= VERSUS_WIN_GOALS;
+        state.ServeTo = conceded;
+        ball.Position = (Vector2){WORLD_WIDTH / 2, WORLD_HEIGHT / 2};
+        ball.State = Ball::SPARKING;
+        ball.sparkTimer = 1.0f;
+    }
+}
+
+uint32_t VersusChecksum(VersusState const &state)
+{
+    // Field by field, padding bytes are whatever the last copy left there
+    uint32_t hash = FNV_OFFSET_BASIS;
+    HashBytes(hash, &state.ball.Position, sizeof(state.ball.Position));
+    HashBytes(hash, &state.ball.Direction, sizeof(state.ball.Direction));
+    HashBytes(hash, &state.ball.Speed, sizeof(state.ball.Speed));
+    HashBytes(hash, &state.ball.sparkTimer, sizeof(state.ball.sparkTimer));
+    int ballState = state.ball.State;
+    HashBytes(hash, &ballState, sizeof(ballState));
+    for (int side = 0; side < 2; side++)
+    {
+        HashBytes(hash, &state.keepers[side].Position, sizeof(state.keepers[side].Position));
+        HashBytes(hash, &state.Score[side], sizeof(state.Score[side]));
+    }
+    int flags = state.ServeTo | state.Pause << 1 | state.GameOver << 2;
+    HashBytes(hash, &flags, sizeof(flags));
+    HashBytes(hash, state.rng.s, sizeof(state.rng.s));
+    return hash;
+}
+
+void VersusSideView(VersusState const &state, int side, World &view)
+{
+    view = {};
+    view.ball = state.ball;
+    view.keeper = state.keepers[side];
+    view.goal = state.goals[side];
+    view.score = state.Score[side];
+    view.goals = state.Score[1 - side];
+    view.Pause = state.Pause;
+    view.GameOver = state.GameOver;
+    view.rng = state.rng;
+    if (side == VERSUS_LEFT)
+    {
+        view.ball.Position.x = WORLD_WIDTH - view.ball.Position.x;
+        view.ball.Direction.x = -view.ball.Direction.x;
+        view.keeper.Position.x = WORLD_WIDTH - view.keeper.Position.x;
+        view.goal.Position.x = WORLD_WIDTH - (view.goal.Position.x - view.goal.Width);
+    }
+}
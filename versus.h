@@ -0,0 +1,40 @@
+#ifndef VERSUS_H
+#define VERSUS_H
+
+#include "simulation.h"
+
+// Two-player rules: a keeper and a goal on each side, the end walls outside the goals bounce the ball.
+// A goal scores for the other side, first to VERSUS_WIN_GOALS wins. Every save speeds the ball up a little
+// so rallies end. Plain data without pointers or particles, so a tick can be saved, restored and simulated
+// again as often as rollback needs.
+enum
+{
+    VERSUS_LEFT,
+    VERSUS_RIGHT
+};
+
+int const VERSUS_WIN_GOALS = 5;
+
+struct VersusState
+{
+    Ball ball;
+    Goalkeeper keepers[2];
+    Goal goals[2];
+    int Score[2];  // Goals scored by each side
+    int ServeTo;   // Side the ball heads for after its spark at the center
+    float BaseSpeed;
+    bool Pause;
+    bool GameOver; // The side with VERSUS_WIN_GOALS won
+    Rng rng;
+};
+
+void InitVersus(VersusState &state, uint64_t seed);
+void ResetVersus(VersusState &state); // New game, the RNG carries on
+void StepVersus(VersusState &state, SimInput const inputs[2], float deltaTime);
+uint32_t VersusChecksum(VersusState const &state);
+
+// The state as a single-player World, mirrored so that `side` defends the right goal.
+// Lets the keeper AI and the scripted inputs written for World play either side.
+void VersusSideView(VersusState const &state, int side, World &view);
+
+#endif